@@ -0,0 +1,207 @@
+/********************************************
+ *  Project     : Le Maze
+ *  File        : feed.h
+ *  Author      : Kai Parsons
+ *  Date        : 2026-10-18
+ *  Description : Shared memory feed the game
+ *                publishes to and spectators
+ *                follow.
+ ********************************************/
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#include <windows.h>
+
+/*
+ * The game writes, spectators only read, and nobody ever waits on anybody else.
+ *
+ *  - The board is published once per game. `ready` is cleared and `session` bumped before the
+ *    tiles are rewritten, so a reader that sees the same session before and after copying got
+ *    a whole board.
+ *  - The player position sits behind a seqlock for catching up from a snapshot.
+ *  - Every move is also appended to a ring of absolute positions. A spectator that falls more
+ *    than RING_SIZE moves behind resynchronises from the snapshot instead.
+ */
+namespace feed {
+    constexpr uint32_t MAGIC = 0x464D454C;
+    constexpr uint32_t VERSION = 1;
+    constexpr size_t RING_SIZE = 4096;
+    constexpr int SNAPSHOT_ATTEMPTS = 64;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t capacity;
+        std::atomic<uint32_t> session;
+        std::atomic<uint32_t> ready;
+        uint32_t rows, cols;
+        std::atomic<uint64_t> sequence;
+        std::atomic<uint64_t> player;
+        std::atomic<uint64_t> head;
+        std::array<std::atomic<uint64_t>, RING_SIZE> ring;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "the feed needs lock-free 64-bit atomics");
+
+    struct Mapping {
+        HANDLE handle = nullptr;
+        Header* header = nullptr;
+    };
+
+    inline std::string mapping_name(const std::string& name) {
+        return "Local\\LeMaze." + name;
+    }
+
+    inline uint64_t pack(const std::pair<int, int>& position) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(position.first)) << 32) | static_cast<uint32_t>(position.second);
+    }
+
+    inline std::pair<int, int> unpack(uint64_t packed) {
+        return {static_cast<int>(packed >> 32), static_cast<int>(packed & 0xFFFFFFFF)};
+    }
+
+    inline char* tiles(const Mapping& mapping) {
+        return reinterpret_cast<char*>(mapping.header) + sizeof(Header);
+    }
+
+    inline void close(Mapping& mapping) {
+        if (mapping.header) UnmapViewOfFile(mapping.header);
+        if (mapping.handle) CloseHandle(mapping.handle);
+        mapping = {};
+    }
+
+    // Creates the feed, or takes over one left by an earlier game if it is large enough
+    inline bool create(Mapping& mapping, const std::string& name, size_t rows, size_t cols) {
+        uint64_t size = sizeof(Header) + rows * cols;
+
+        mapping.handle = CreateFileMappingA(
+                INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), mapping_name(name).c_str()
+        );
+        if (!mapping.handle) return false;
+
+        bool existed = GetLastError() == ERROR_ALREADY_EXISTS;
+
+        mapping.header = static_cast<Header*>(MapViewOfFile(mapping.handle, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+        if (!mapping.header) {
+            close(mapping);
+            return false;
+        }
+
+        Header& header = *mapping.header;
+
+        if (existed) {
+            if (header.magic != MAGIC || header.version != VERSION || header.capacity < rows * cols) {
+                close(mapping);
+                return false;
+            }
+
+            // A game that died halfway through a move left the sequence odd, which would invert the seqlock
+            uint64_t sequence = header.sequence.load(std::memory_order_relaxed);
+            if (sequence % 2 != 0) header.sequence.store(sequence + 1, std::memory_order_release);
+
+            header.ready.store(0, std::memory_order_release);
+            header.session.fetch_add(1, std::memory_order_acq_rel);
+            return true;
+        }
+
+        new (mapping.header) Header();
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.capacity = rows * cols;
+        return true;
+    }
+
+    inline void publish_board(Mapping& mapping, const std::vector<std::vector<char>>& maze) {
+        Header& header = *mapping.header;
+
+        header.ready.store(0, std::memory_order_release);
+        header.session.fetch_add(1, std::memory_order_acq_rel);
+
+        header.rows = static_cast<uint32_t>(maze.size());
+        header.cols = static_cast<uint32_t>(maze[0].size());
+
+        char* out = tiles(mapping);
+        for (const auto& row : maze) {
+            memcpy(out, row.data(), row.size());
+            out += row.size();
+        }
+
+        header.ready.store(1, std::memory_order_release);
+    }
+
+    inline void publish_move(Mapping& mapping, const std::pair<int, int>& player) {
+        Header& header = *mapping.header;
+        uint64_t packed = pack(player);
+
+        uint64_t sequence = header.sequence.load(std::memory_order_relaxed);
+        header.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        header.player.store(packed, std::memory_order_relaxed);
+        header.sequence.store(sequence + 2, std::memory_order_release);
+
+        uint64_t head = header.head.load(std::memory_order_relaxed);
+        header.ring[head % RING_SIZE].store(packed, std::memory_order_relaxed);
+        header.head.store(head + 1, std::memory_order_release);
+    }
+
+    inline bool open(Mapping& mapping, const std::string& name) {
+        mapping.handle = OpenFileMappingA(FILE_MAP_READ, FALSE, mapping_name(name).c_str());
+        if (!mapping.handle) return false;
+
+        mapping.header = static_cast<Header*>(MapViewOfFile(mapping.handle, FILE_MAP_READ, 0, 0, 0));
+        if (!mapping.header || mapping.header->magic != MAGIC || mapping.header->version != VERSION) {
+            close(mapping);
+            return false;
+        }
+
+        return true;
+    }
+
+    // Gives up after SNAPSHOT_ATTEMPTS torn reads, the writer may have died in the middle of a move
+    inline bool snapshot(const Mapping& mapping, std::pair<int, int>& player) {
+        const Header& header = *mapping.header;
+
+        for (int attempt = 0; attempt < SNAPSHOT_ATTEMPTS; ++attempt) {
+            uint64_t before = header.sequence.load(std::memory_order_acquire);
+            uint64_t packed = header.player.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (before % 2 == 0 && header.sequence.load(std::memory_order_relaxed) == before) {
+                player = unpack(packed);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Copies the board, returning false if there is none yet or it changed while being read
+    inline bool read_board(const Mapping& mapping, std::vector<std::vector<char>>& maze, uint32_t& session) {
+        const Header& header = *mapping.header;
+
+        session = header.session.load(std::memory_order_acquire);
+        if (!header.ready.load(std::memory_order_acquire)) return false;
+
+        uint32_t rows = header.rows, cols = header.cols;
+        if (rows == 0 || cols == 0 || static_cast<uint64_t>(rows) * cols > header.capacity) return false;
+
+        const char* in = tiles(mapping);
+        maze.resize(rows);
+        for (auto& row : maze) {
+            row.assign(in, in + cols);
+            in += cols;
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return header.ready.load(std::memory_order_relaxed) && header.session.load(std::memory_order_relaxed) == session;
+    }
+}
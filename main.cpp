@@ -8,126 +8,404 @@
 
 #include <iostream>
 #include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <filesystem>
 #include <conio.h>
 
 #include <vector>
-#include <stack>
-#include <queue>
+#include <array>
+#include <span>
 #include <unordered_map>
 #include <unordered_set>
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <chrono>
 #include <random>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <bit>
+#include <type_traits>
+#include <functional>
+#include <memory>
+
+#include <thread>
+#include <atomic>
+#include <mutex>
 
 #include <windows.h>
 
+#include "render.h"
+#include "feed.h"
+#include "stats.h"
+
 using namespace std;
 
-namespace terminal {
-    void enable_virtual_terminal() {
-        HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
-        DWORD dwMode = 0;
-        GetConsoleMode(hOut, &dwMode);
-        dwMode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
-        SetConsoleMode(hOut, dwMode);
+#ifdef LEMAZE_STATS
+namespace stats {
+    // Every block carries its size and tag in front, so a free is charged to whoever allocated it
+    constexpr size_t PREFIX = alignof(max_align_t);
+
+    void* allocate(size_t size) {
+        char* block = static_cast<char*>(malloc(size + PREFIX));
+        if (!block) return nullptr;
+
+        Tag tag = current;
+        memcpy(block, &size, sizeof(size));
+        memcpy(block + sizeof(size), &tag, sizeof(tag));
+        allocated(tag, size);
+
+        return block + PREFIX;
+    }
+
+    void release(void* pointer) {
+        if (!pointer) return;
+
+        char* block = static_cast<char*>(pointer) - PREFIX;
+        size_t size;
+        Tag tag;
+        memcpy(&size, block, sizeof(size));
+        memcpy(&tag, block + sizeof(size), sizeof(tag));
+        freed(tag, size);
+
+        free(block);
+    }
+}
+
+void* operator new(size_t size) {
+    void* pointer = stats::allocate(size);
+    if (!pointer) throw bad_alloc();
+    return pointer;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    return stats::allocate(size);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept {
+    return stats::allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    stats::release(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    stats::release(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    stats::release(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    stats::release(pointer);
+}
+
+void operator delete(void* pointer, const nothrow_t&) noexcept {
+    stats::release(pointer);
+}
+
+void operator delete[](void* pointer, const nothrow_t&) noexcept {
+    stats::release(pointer);
+}
+#endif
+
+namespace cli {
+    vector<string> split(const string& text, char separator) {
+        vector<string> parts;
+        stringstream stream(text);
+        string part;
+
+        while (getline(stream, part, separator)) parts.push_back(part);
+
+        return parts;
+    }
+
+    // Collects the "--name value" pairs that follow a mode flag
+    bool options(int argc, char* argv[], int first, vector<pair<string, string>>& pairs) {
+        for (int i = first; i < argc; i += 2) {
+            if (i + 1 >= argc) {
+                cerr << "Missing value for " << argv[i] << endl;
+                return false;
+            }
+
+            pairs.emplace_back(argv[i], argv[i + 1]);
+        }
+
+        return true;
     }
 
-    void cursor(bool visible) {
-        HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
-        CONSOLE_CURSOR_INFO cursorInfo;
-        GetConsoleCursorInfo(hOut, &cursorInfo);
+    bool parse_size(const string& text, pair<unsigned int, unsigned int>& size) {
+        size_t x = text.find('x');
+        if (x == string::npos) return false;
 
-        if (visible) {
-            cursorInfo.bVisible = TRUE;
-        } else cursorInfo.bVisible = FALSE;
-        SetConsoleCursorInfo(hOut, &cursorInfo);
+        size = {stoul(text.substr(0, x)), stoul(text.substr(x + 1))};
+        return true;
     }
 
-    void init() {
-        enable_virtual_terminal();
-        cursor(false);
-        SetConsoleOutputCP(CP_UTF8);
-        SetConsoleTitle("Le Maze");
+    bool valid_size(unsigned int rows, unsigned int cols) {
+        if (rows < 3 || cols < 3 || rows % 2 == 0 || cols % 2 == 0) {
+            cerr << "Maze sizes must be odd and at least 3x3" << endl;
+            return false;
+        }
+
+        return true;
     }
+}
 
-    void deinit() {
-        cursor(true);
+namespace grid {
+    size_t next_power_of_two(size_t value) {
+        size_t power = 1;
+        while (power < value) power <<= 1;
+        return power;
     }
+
+    struct RowMajor {
+        size_t cols = 0;
+
+        void resize(size_t, size_t new_cols) {
+            cols = new_cols;
+        }
+
+        size_t index(size_t r, size_t c) const {
+            return r * cols + c;
+        }
+    };
+
+    // 8x8 tiles of one byte cells, so every tile fills exactly one cache line
+    struct Tiled {
+        static constexpr size_t TILE = 8;
+        size_t tiles_per_row = 0;
+
+        void resize(size_t, size_t cols) {
+            tiles_per_row = (cols + TILE - 1) / TILE;
+        }
+
+        size_t index(size_t r, size_t c) const {
+            size_t tile = (r / TILE) * tiles_per_row + c / TILE;
+            return tile * TILE * TILE + (r % TILE) * TILE + c % TILE;
+        }
+    };
+
+    /*
+     * Z-order over the grid padded to powers of two. The low bits of both coordinates are
+     * interleaved, and whatever the longer side has left over selects the square block.
+     */
+    struct Morton {
+        int interleaved_bits = 0;
+        bool tall = false;
+
+        void resize(size_t rows, size_t cols) {
+            size_t padded_rows = next_power_of_two(rows), padded_cols = next_power_of_two(cols);
+            interleaved_bits = countr_zero(min(padded_rows, padded_cols));
+            tall = padded_rows > padded_cols;
+        }
+
+        static uint64_t spread(uint64_t value) {
+            value &= 0xFFFFFFFF;
+            value = (value | (value << 16)) & 0x0000FFFF0000FFFF;
+            value = (value | (value << 8)) & 0x00FF00FF00FF00FF;
+            value = (value | (value << 4)) & 0x0F0F0F0F0F0F0F0F;
+            value = (value | (value << 2)) & 0x3333333333333333;
+            value = (value | (value << 1)) & 0x5555555555555555;
+            return value;
+        }
+
+        size_t index(size_t r, size_t c) const {
+            size_t mask = (size_t{1} << interleaved_bits) - 1;
+            size_t block = tall ? r >> interleaved_bits : c >> interleaved_bits;
+            return (block << (2 * interleaved_bits)) | (spread(r & mask) << 1) | spread(c & mask);
+        }
+
+        size_t capacity(size_t rows, size_t cols) const {
+            size_t longer = tall ? rows : cols;
+            size_t blocks = (longer + (size_t{1} << interleaved_bits) - 1) >> interleaved_bits;
+            return blocks << (2 * interleaved_bits);
+        }
+    };
+
+    // Flat cell storage with the same grid[r][c] / size() access as vector<vector<char>>
+    template <typename Layout>
+    struct Grid {
+        Layout layout;
+        size_t rows = 0, cols = 0;
+        vector<char> cells;
+
+        struct Row {
+            Grid& grid;
+            size_t r;
+
+            char& operator[](size_t c) const {
+                return grid.cells[grid.layout.index(r, c)];
+            }
+
+            size_t size() const {
+                return grid.cols;
+            }
+        };
+
+        struct ConstRow {
+            const Grid& grid;
+            size_t r;
+
+            char operator[](size_t c) const {
+                return grid.cells[grid.layout.index(r, c)];
+            }
+
+            size_t size() const {
+                return grid.cols;
+            }
+        };
+
+        void assign(size_t new_rows, size_t new_cols, char value) {
+            rows = new_rows;
+            cols = new_cols;
+            layout.resize(rows, cols);
+
+            size_t capacity;
+            if constexpr (is_same_v<Layout, Morton>) {
+                capacity = layout.capacity(rows, cols);
+            } else if constexpr (is_same_v<Layout, Tiled>) {
+                capacity = ((rows + Tiled::TILE - 1) / Tiled::TILE) * layout.tiles_per_row * Tiled::TILE * Tiled::TILE;
+            } else capacity = rows * cols;
+
+            cells.assign(capacity, value);
+        }
+
+        size_t size() const {
+            return rows;
+        }
+
+        Row operator[](size_t r) {
+            return {*this, r};
+        }
+
+        ConstRow operator[](size_t r) const {
+            return {*this, r};
+        }
+    };
 }
 
 namespace map {
-    const vector<pair<int, int>> directions = {
+    const array<pair<int, int>, 4> directions = {{
             {0, 2},
             {0, -2},
             {2, 0},
             {-2, 0}
+    }};
+
+    const vector<string> algorithms = {"backtracker"};
+
+    // Directions are stored as indices into map::directions, tried from the back
+    struct Frame {
+        int r, c;
+        array<uint8_t, 4> dirs;
+        uint8_t remaining;
+    };
+
+    // Buffers kept between generations so repeated runs do not reallocate
+    template <typename Maze = vector<vector<char>>, typename Visited = vector<vector<bool>>>
+    struct BasicWorkspace {
+        Maze maze;
+        Visited visited;
+        vector<Frame> stack;
+        vector<tuple<int, int, int>> queue;
     };
 
-    constexpr char TILE_WALL = '1';
-    constexpr char TILE_PATH = '0';
-    constexpr char TILE_PLAYER = '2';
-    constexpr char TILE_GOAL = '3';
+    using Workspace = BasicWorkspace<>;
+
+    void clear_visited(vector<vector<bool>>& visited, size_t rows, size_t cols) {
+        visited.resize(rows);
+        for (auto& row : visited) row.assign(cols, false);
+    }
+
+    template <typename Layout>
+    void clear_visited(grid::Grid<Layout>& visited, size_t rows, size_t cols) {
+        visited.assign(rows, cols, false);
+    }
+
+    Frame shuffled_frame(int r, int c, mt19937& gen) {
+        Frame frame = {r, c, {0, 1, 2, 3}, 4};
+        shuffle(frame.dirs.begin(), frame.dirs.end(), gen);
+        return frame;
+    }
+
+    struct NoCarve {
+        void operator()(int, int) const {}
+    };
 
-    void dfs(int start_r, int start_c, vector<vector<char>>& maze, unordered_set<string>& visited) {
-        stack<tuple<int, int, vector<pair<int, int>>>> stk;
-        stk.emplace(start_r, start_c, directions);
-        visited.insert(to_string(start_r) + "," + to_string(start_c));
+    // An OnCarve that returns bool can stop the carving early by returning false
+    template <typename Maze, typename Visited, typename OnCarve = NoCarve>
+    void dfs(
+            int start_r, int start_c, Maze& maze, Visited& visited, mt19937& gen, vector<Frame>& stk,
+            OnCarve on_carve = {}
+    ) {
+        int rows = static_cast<int>(maze.size()), cols = static_cast<int>(maze[0].size());
 
-        random_device rd;
-        mt19937 gen(rd());
+        stk.clear();
+        stk.push_back(shuffled_frame(start_r, start_c, gen));
+        visited[start_r][start_c] = true;
 
         while (!stk.empty()) {
-            auto& [r, c, dirs] = stk.top();
+            Frame& top = stk.back();
 
-            if (dirs.empty()) {
-                stk.pop();
+            if (top.remaining == 0) {
+                stk.pop_back();
                 continue;
             }
 
-            auto dir = dirs.back();
-            dirs.pop_back();
-
-            int dr = dir.first, dc = dir.second;
+            auto [dr, dc] = directions[top.dirs[--top.remaining]];
+            int r = top.r, c = top.c;
             int nr = r + dr;
             int nc = c + dc;
 
-            if (nr <= 0 || nc <= 0 || nr >= maze.size() - 1 || nc >= maze[0].size() - 1) continue;
-
-            string key = to_string(nr) + "," + to_string(nc);
-            if (visited.count(key)) continue;
+            if (nr <= 0 || nc <= 0 || nr >= rows - 1 || nc >= cols - 1) continue;
+            if (visited[nr][nc]) continue;
 
             maze[r + dr / 2][c + dc / 2] = TILE_PATH;
-            visited.insert(key);
+            if constexpr (is_same_v<invoke_result_t<OnCarve&, int, int>, bool>) {
+                if (!on_carve(r + dr / 2, c + dc / 2)) return;
+            } else on_carve(r + dr / 2, c + dc / 2);
+            visited[nr][nc] = true;
 
-            vector<pair<int, int>> new_dirs = directions;
-            shuffle(new_dirs.begin(), new_dirs.end(), gen);
-            stk.emplace(nr, nc, new_dirs);
+            stk.push_back(shuffled_frame(nr, nc, gen));
         }
     }
 
-    tuple<pair<int, int>, int> find_farthest_point(const vector<vector<char>>& maze, int start_r, int start_c) {
-        size_t rows = maze.size(), cols = maze[0].size();
-        vector<vector<bool>> visited(rows, vector<bool>(cols, false));
-        queue<tuple<int, int, int>> q;
+    template <typename Maze, typename Visited>
+    tuple<pair<int, int>, int> find_farthest_point(
+            const Maze& maze, int start_r, int start_c, Visited& visited, vector<tuple<int, int, int>>& q
+    ) {
+        int rows = static_cast<int>(maze.size()), cols = static_cast<int>(maze[0].size());
+        clear_visited(visited, rows, cols);
 
-        q.emplace(start_r, start_c, 0);
+        q.clear();
+        q.emplace_back(start_r, start_c, 0);
         visited[start_r][start_c] = true;
 
         pair<int, int> farthest = {start_r, start_c};
         int max_dist = 0;
 
-        vector<pair<int, int>> deltas = {
+        constexpr array<pair<int, int>, 4> deltas = {{
                 {1, 0},
                 {-1, 0},
                 {0, 1},
                 {0, -1}
-        };
+        }};
 
-        while (!q.empty()) {
-            auto [r, c, dist] = q.front();
-            q.pop();
+        // Every cell is queued once, so the queue is a flat vector walked by index
+        for (size_t head = 0; head < q.size(); ++head) {
+            auto [r, c, dist] = q[head];
 
             if (dist > max_dist) {
                 max_dist = dist;
@@ -139,7 +417,7 @@ namespace map {
                 if (nr >= 0 && nc >= 0 && nr < rows && nc < cols &&
                     !visited[nr][nc] && maze[nr][nc] == TILE_PATH) {
                     visited[nr][nc] = true;
-                    q.emplace(nr, nc, dist + 1);
+                    q.emplace_back(nr, nc, dist + 1);
                 }
             }
         }
@@ -147,248 +425,2183 @@ namespace map {
         return {farthest, max_dist};
     }
 
-    vector<vector<char>> generate_empty_maze(unsigned int rows, unsigned int cols) {
-        vector<vector<char>> maze(rows, vector<char>(cols, TILE_WALL));
-        for (int r = 1; r < rows; r += 2) {
-            for (int c = 1; c < cols; c += 2) {
+    tuple<pair<int, int>, int> find_farthest_point(const vector<vector<char>>& maze, int start_r, int start_c) {
+        vector<vector<bool>> visited;
+        vector<tuple<int, int, int>> q;
+        return find_farthest_point(maze, start_r, start_c, visited, q);
+    }
+
+    void reset_maze(vector<vector<char>>& maze, unsigned int rows, unsigned int cols) {
+        maze.resize(rows);
+        for (unsigned int r = 0; r < rows; ++r) {
+            maze[r].assign(cols, TILE_WALL);
+            if (r % 2 == 0) continue;
+
+            for (unsigned int c = 1; c < cols; c += 2) {
                 maze[r][c] = TILE_PATH;
             }
         }
+    }
+
+    template <typename Layout>
+    void reset_maze(grid::Grid<Layout>& maze, unsigned int rows, unsigned int cols) {
+        maze.assign(rows, cols, TILE_WALL);
+        for (unsigned int r = 1; r < rows; r += 2) {
+            for (unsigned int c = 1; c < cols; c += 2) {
+                maze[r][c] = TILE_PATH;
+            }
+        }
+    }
+
+    vector<vector<char>> generate_empty_maze(unsigned int rows, unsigned int cols) {
+        stats::Scope scope(stats::Map);
+
+        vector<vector<char>> maze;
+        reset_maze(maze, rows, cols);
         return maze;
     }
 
+    // Generates into ws.maze, reusing every buffer of the workspace
+    template <typename Maze, typename Visited>
+    tuple<pair<int, int>, int> generate_maze(
+            BasicWorkspace<Maze, Visited>& ws, unsigned int rows, unsigned int cols, pair<int, int> start, unsigned int seed
+    ) {
+        stats::Scope scope(stats::Map);
+        mt19937 gen(seed);
+
+        reset_maze(ws.maze, rows, cols);
+        clear_visited(ws.visited, rows, cols);
+        map::dfs(start.first, start.second, ws.maze, ws.visited, gen, ws.stack);
+
+        auto [end_cell, max_dist] = find_farthest_point(ws.maze, start.first, start.second, ws.visited, ws.queue);
+
+        ws.maze[end_cell.first][end_cell.second] = TILE_GOAL;
+
+        return {end_cell, max_dist};
+    }
+
     tuple<vector<vector<char>>, pair<int, int>, int> generate_maze(
-            unsigned int rows, unsigned int cols, pair<int, int> start
+            unsigned int rows, unsigned int cols, pair<int, int> start, unsigned int seed = random_device{}()
     ) {
-        vector<vector<char>> map = map::generate_empty_maze(rows, cols);
+        Workspace ws;
+        auto [end_cell, max_dist] = generate_maze(ws, rows, cols, start, seed);
 
-        unordered_set<string> visited;
-        map::dfs(start.first, start.second, map, visited);
+        return {std::move(ws.maze), end_cell, max_dist};
+    }
+
+    constexpr size_t PUBLISH_BATCH = 256;
+
+    // Shared between the generating thread and the game loop, guarded by `lock` apart from `stop`
+    struct Progress {
+        atomic<bool> stop = false;
+        mutex lock;
+        vector<pair<int, int>> carved;
+        bool done = false;
+        pair<int, int> end_cell = {-1, -1};
+        int max_dist = 0;
+    };
+
+    // Same maze as generate_maze, but carved passages are handed over in batches while the DFS runs.
+    // Returns false without finishing the maze if `progress.stop` was set.
+    bool generate_progressively(
+            Workspace& ws, unsigned int rows, unsigned int cols, pair<int, int> start, unsigned int seed,
+            Progress& progress
+    ) {
+        stats::Scope scope(stats::Map);
+        mt19937 gen(seed);
+
+        reset_maze(ws.maze, rows, cols);
+        clear_visited(ws.visited, rows, cols);
 
-        unsigned int max_dist;
-        pair<int, int> end_cell;
-        tie(end_cell, max_dist) = find_farthest_point(map, 1, 1);
+        vector<pair<int, int>> batch;
+        auto publish = [&]() {
+            lock_guard guard(progress.lock);
+            progress.carved.insert(progress.carved.end(), batch.begin(), batch.end());
+            batch.clear();
+        };
+
+        map::dfs(start.first, start.second, ws.maze, ws.visited, gen, ws.stack, [&](int r, int c) {
+            batch.emplace_back(r, c);
+            if (batch.size() >= PUBLISH_BATCH) publish();
+            return !progress.stop.load(memory_order_relaxed);
+        });
+        if (progress.stop) return false;
+        publish();
+
+        auto [end_cell, max_dist] = find_farthest_point(ws.maze, start.first, start.second, ws.visited, ws.queue);
+
+        lock_guard guard(progress.lock);
+        progress.end_cell = end_cell;
+        progress.max_dist = max_dist;
+        progress.done = true;
+        return true;
+    }
+
+    // Hands over a finished maze in one go, as if its passages had all been carved in one batch
+    void publish(Progress& progress, const vector<vector<char>>& maze, const pair<int, int>& end_cell, int max_dist) {
+        lock_guard guard(progress.lock);
 
-        map[end_cell.first][end_cell.second] = TILE_GOAL;
+        for (size_t r = 0; r < maze.size(); ++r) {
+            for (size_t c = 0; c < maze[r].size(); ++c) {
+                // Cells at odd coordinates are open from the start, only the walls between them get carved
+                if ((r % 2 != c % 2) && maze[r][c] != TILE_WALL) progress.carved.emplace_back(r, c);
+            }
+        }
 
-        return {map, end_cell, max_dist};
+        progress.end_cell = end_cell;
+        progress.max_dist = max_dist;
+        progress.done = true;
     }
 }
 
-namespace render {
-    const unordered_map<string, string> color_codes = {
-            {"fg_0",  "\033[30m"},
-            {"fg_1",  "\033[37m"},
-            {"fg_2",  "\033[31m"},
-            {"fg_3",  "\033[33m"},
-            {"bg_0",  "\033[40m"},
-            {"bg_1",  "\033[47m"},
-            {"bg_2",  "\033[41m"},
-            {"bg_3",  "\033[43m"},
-            {"reset", "\033[0m"}
+namespace analysis {
+    struct Metrics {
+        unsigned int cells = 0;
+        unsigned int dead_ends = 0;
+        unsigned int junctions = 0;
+        vector<unsigned int> corridor_lengths;
+        double river_factor = 0;
+        int solution_length = 0;
     };
 
-    constexpr string PIXEL = "▀";
+    bool passable(const vector<vector<char>>& maze, size_t r, size_t c) {
+        return maze[r][c] != map::TILE_WALL;
+    }
 
-    void up(int characters, ostringstream& out) {
-        out << "\033[" << characters << "A";
+    void count_corridor(Metrics& metrics, unsigned int length) {
+        if (length >= metrics.corridor_lengths.size()) metrics.corridor_lengths.resize(length + 1, 0);
+        metrics.corridor_lengths[length]++;
     }
 
-    void right(int characters, ostringstream& out) {
-        out << "\033[" << characters << "C";
+    // Open walls around a cell, map::directions are steps between cells so half of one is the wall
+    int degree(const vector<vector<char>>& maze, size_t r, size_t c) {
+        int open = 0;
+        for (auto [dr, dc] : map::directions) open += passable(maze, r + dr / 2, c + dc / 2);
+        return open;
     }
 
-    void render_pixel(ostringstream& out, const vector<vector<char>>& matrix, size_t row, size_t col) {
-        const char& top = matrix[row][col];
-        const char& bottom = matrix[row + 1][col];
+    /*
+     * Single raster pass over the cells (odd coordinates) of a generated maze.
+     * A corridor is a chain of cells with exactly two openings between two nodes (dead ends or
+     * junctions), measured in cells including both nodes, so it follows the turns of the passage.
+     * Every node walks its corridors and each one is counted from the end with the smaller index.
+     * The river factor is the share of cells that are neither dead ends nor junctions.
+     */
+    void analyse(const vector<vector<char>>& maze, int solution_length, Metrics& metrics) {
+        size_t rows = maze.size(), cols = maze[0].size();
+
+        metrics.cells = metrics.dead_ends = metrics.junctions = 0;
+        fill(metrics.corridor_lengths.begin(), metrics.corridor_lengths.end(), 0);
+        metrics.solution_length = solution_length;
 
-        string fg_code = color_codes.at("fg_" + string(1, top));
-        string bg_code = color_codes.at("bg_" + string(1, bottom));
+        for (size_t r = 1; r + 1 < rows; r += 2) {
+            for (size_t c = 1; c + 1 < cols; c += 2) {
+                int open = degree(maze, r, c);
 
-        out << fg_code << bg_code << PIXEL;
-    }
+                metrics.cells++;
+                if (open == 1) metrics.dead_ends++;
+                else if (open >= 3) metrics.junctions++;
 
-    void render(vector<vector<char>>& old_matrix, const vector<vector<char>>& new_matrix, bool first_frame) {
-        ostringstream out;
+                if (open == 2) continue;
 
-        if (!first_frame) up(static_cast<int>(ceil(old_matrix.size() / 2) + 1), out);
+                for (size_t first = 0; first < map::directions.size(); ++first) {
+                    auto [dr, dc] = map::directions[first];
+                    if (!passable(maze, r + dr / 2, c + dc / 2)) continue;
 
-        for (size_t row = 0; row + 1 < old_matrix.size(); row += 2) {
-            for (size_t col = 0; col < old_matrix[row].size(); ++col) {
-                if (!first_frame) {
-                    if (
-                        old_matrix[row][col] != new_matrix[row][col] ||
-                        old_matrix[row + 1][col] != new_matrix[row + 1][col]
-                    ) {
-                        render_pixel(out, new_matrix, row, col);
-                    } else right(1, out);
-                } else render_pixel(out, new_matrix, row, col);
-            }
+                    size_t cr = r + dr, cc = c + dc, arrived = first;
+                    unsigned int length = 2;
 
-            out << color_codes.at("reset") << endl;
-        }
+                    while (degree(maze, cr, cc) == 2) {
+                        // Directions come in opposite pairs, so d ^ 1 is the way back
+                        size_t next = 0;
+                        while (next == (arrived ^ 1) ||
+                               !passable(maze, cr + map::directions[next].first / 2, cc + map::directions[next].second / 2)) next++;
 
-        if (old_matrix.size() % 2 != 0) {
-            size_t last_row = old_matrix.size() - 1;
+                        cr += map::directions[next].first;
+                        cc += map::directions[next].second;
+                        arrived = next;
+                        length++;
+                    }
 
-            for (int i = 0; i <= old_matrix[last_row].size() - 1; ++i) {
-                if (!first_frame) {
-                    if (old_matrix[last_row][i] != new_matrix[last_row][i]) {
-                        string code = color_codes.at("fg_" + string(1, new_matrix[last_row][i]));
-                        out << code << PIXEL;
-                    } else right(1, out);
-                } else {
-                    string code = color_codes.at("fg_" + string(1, new_matrix[last_row][i]));
-                    out << code << PIXEL;
+                    if (pair{r * cols + c, first} < pair{cr * cols + cc, arrived ^ 1}) count_corridor(metrics, length);
                 }
             }
-
-            out << color_codes.at("reset") << endl;
         }
 
-        cout << out.str();
+        unsigned int flowing = metrics.cells - metrics.dead_ends - metrics.junctions;
+        metrics.river_factor = metrics.cells ? static_cast<double>(flowing) / metrics.cells : 0;
     }
 }
 
-namespace game {
-    const unordered_set<char> solids = {map::TILE_WALL};
+namespace selection {
+    // Minimum difficulty: share of open tiles on the solution path, and dead ends per cell
+    struct Target {
+        double min_solution = 0;
+        double min_dead_ends = 0;
+    };
 
-    enum Key {
-        ArrowPrefix = 224,
-        CtrlC = 3,
-        Up = 72,
-        Down = 80,
-        Left = 75,
-        Right = 77
+    struct Result {
+        unsigned int seed = 0;
+        size_t index = 0;
+        pair<int, int> end_cell = {-1, -1};
+        int max_dist = 0;
+        double solution = 0;
+        double dead_ends = 0;
+        bool qualified = false;
     };
 
-    const pair<int, int> EXIT_CODE = {2, 2};
+    unsigned int derive_seed(unsigned int base, size_t index) {
+        uint64_t z = (static_cast<uint64_t>(base) << 32) + index + 0x9E3779B97F4A7C15;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+        return static_cast<unsigned int>(z ^ (z >> 31));
+    }
 
-    vector<vector<char>> update_matrix(
-            const vector<vector<char>>& map,
-            vector<vector<char>>& old_matrix,
-            pair<int, int>& player_location,
-            const pair<int, int>& offset
+    // How close a candidate comes to the target, 1 or more means it qualifies
+    double score(const Result& result, const Target& target) {
+        double solution = target.min_solution > 0 ? result.solution / target.min_solution : 1;
+        double dead_ends = target.min_dead_ends > 0 ? result.dead_ends / target.min_dead_ends : 1;
+        return min(solution, dead_ends);
+    }
+
+    /*
+     * Generates up to `candidates` mazes from seeds derived from `base_seed` on a pool of threads.
+     * Candidates are handed out in index order and nobody starts one past the lowest qualifying
+     * index, so the winner is the same for any thread count. When nothing qualifies the closest
+     * candidate is returned with `qualified` unset. With `maze` set the winner's board is kept in it,
+     * so it does not have to be generated again. Setting `stop` makes the workers give up after
+     * their current candidate, leaving the result meaningless.
+     */
+    Result select(
+            unsigned int rows, unsigned int cols, pair<int, int> start, unsigned int base_seed,
+            size_t candidates, unsigned int threads, const Target& target, vector<vector<char>>* maze = nullptr,
+            const atomic<bool>* stop = nullptr
     ) {
-        int x = player_location.first;
-        int y = player_location.second;
+        atomic<size_t> next = 0;
+        atomic<size_t> winner = numeric_limits<size_t>::max();
 
-        int new_x = x + offset.first;
-        int new_y = y + offset.second;
+        mutex lock;
+        Result best;
+        double best_score = -1;
 
-        if (new_x < 0 || new_y < 0) return old_matrix;
-        if (new_x > old_matrix.size() - 1 || new_y > old_matrix[0].size() - 1) return old_matrix;
+        auto worker = [&]() {
+            // Tags are per thread, so a fresh worker starts out charging everything to "other"
+            stats::Scope scope(stats::Map);
+            map::Workspace ws;
+            analysis::Metrics metrics;
 
-        if (!solids.contains(old_matrix[new_x][new_y])) {
-            vector<vector<char>> new_matrix = old_matrix;
+            for (size_t i = next++; i < candidates && i < winner && !(stop && *stop); i = next++) {
+                Result result;
+                result.index = i;
+                result.seed = derive_seed(base_seed, i);
 
-            new_matrix[x][y] = map[x][y];
-            new_matrix[new_x][new_y] = map::TILE_PLAYER;
+                tie(result.end_cell, result.max_dist) = map::generate_maze(ws, rows, cols, start, result.seed);
+                analysis::analyse(ws.maze, result.max_dist, metrics);
 
-            player_location = {new_x, new_y};
+                result.solution = static_cast<double>(result.max_dist) / (2 * metrics.cells - 1);
+                result.dead_ends = static_cast<double>(metrics.dead_ends) / metrics.cells;
 
-            return new_matrix;
-        }
+                double candidate_score = score(result, target);
+                result.qualified = candidate_score >= 1;
 
-        return old_matrix;
-    }
+                if (result.qualified) {
+                    size_t current = winner;
+                    while (i < current && !winner.compare_exchange_weak(current, i)) {}
+                }
 
-    pair<int, int> input() {
-        int ch = _getch();
-        if (ch == ArrowPrefix) {
-            pair<int, int> offset = {0, 0};
+                lock_guard guard(lock);
+                bool better = result.qualified
+                        ? !best.qualified || i < best.index
+                        : !best.qualified && (candidate_score > best_score || (candidate_score == best_score && i < best.index));
 
-            switch (_getch()) {
-                case Up:
-                    offset.first -= 1;
-                    break;
-                case Down:
-                    offset.first += 1;
-                    break;
-                case Left:
-                    offset.second -= 1;
-                    break;
-                case Right:
-                    offset.second += 1;
-                    break;
+                if (better) {
+                    best = result;
+                    best_score = candidate_score;
+                    if (maze) *maze = ws.maze;
+                }
             }
+        };
 
-            return offset;
-        } else if (ch == CtrlC) {
-            return EXIT_CODE;
-        }
+        vector<thread> workers;
+        for (unsigned int i = 0; i < min<size_t>(max(1u, threads), candidates); ++i) workers.emplace_back(worker);
+        for (auto& w : workers) w.join();
 
-        return {0, 0};
+        return best;
     }
 }
 
-int main() {
-    terminal::init();
+namespace cache {
+    constexpr uint32_t FORMAT_VERSION = 1;
+    constexpr array<char, 4> MAGIC = {'L', 'M', 'Z', 'C'};
+    constexpr uintmax_t DEFAULT_BUDGET = 256ull << 20;
+    constexpr chrono::minutes STALE_TEMPORARY(10);
+
+    struct Key {
+        string algorithm = "backtracker";
+        unsigned int rows = 0, cols = 0;
+        pair<int, int> start;
+        unsigned int seed = 0;
+    };
 
-    constexpr unsigned int rows = 45;
-    constexpr unsigned int cols = 45;
+    // Fixed-size file header, followed by one wall bit per tile in row-major order
+    struct Header {
+        array<char, 4> magic;
+        uint32_t version;
+        uint32_t rows, cols;
+        int32_t start_r, start_c;
+        uint32_t seed;
+        int32_t end_r, end_c;
+        int32_t max_dist;
+        array<char, 16> algorithm;
+    };
 
-    constexpr pair<int, int> start_position = {1, 1};
+    static_assert(sizeof(Header) == 56, "cache header layout is part of the file format");
+
+    // Outcome of a difficulty selection, keyed by everything the selection depends on
+    struct Choice {
+        Header key;
+        uint64_t candidates;
+        double min_solution;
+        double min_dead_ends;
+        uint64_t index;
+        uint32_t seed;
+        uint32_t qualified;
+    };
 
-    vector<vector<char>> map;
-    pair<int, int> end_cell;
-    int max_dist;
-    tie(map, end_cell, max_dist) = map::generate_maze(rows, cols, start_position);
+    static_assert(sizeof(Choice) == 96, "cache choice layout is part of the file format");
 
-    vector<vector<char>> old_matrix = map;
+    uint64_t fnv1a(uint64_t hash, const void* data, size_t size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) hash = (hash ^ bytes[i]) * 0x100000001B3;
+        return hash;
+    }
 
-    pair<int, int> player_location = start_position;
-    old_matrix[player_location.first][player_location.second] = map::TILE_PLAYER;
+    Header make_header(const Key& key) {
+        Header header = {};
+        header.magic = MAGIC;
+        header.version = FORMAT_VERSION;
+        header.rows = key.rows;
+        header.cols = key.cols;
+        header.start_r = key.start.first;
+        header.start_c = key.start.second;
+        header.seed = key.seed;
+        key.algorithm.copy(header.algorithm.data(), header.algorithm.size() - 1);
+        return header;
+    }
 
-    render::render(old_matrix, old_matrix, true);
+    // Entries are named after a hash of everything that determines the maze, format version included
+    filesystem::path entry_path(const filesystem::path& directory, const Key& key) {
+        Header header = make_header(key);
+        uint64_t hash = fnv1a(0xCBF29CE484222325, &header, sizeof(header));
 
-    vector<vector<char>> new_matrix;
-    pair<int, int> offset;
+        ostringstream name;
+        name << hex << setw(16) << setfill('0') << hash << ".maze";
+        return directory / name.str();
+    }
 
-    int moves = 0;
+    Choice make_choice(const Key& key, size_t candidates, const selection::Target& target) {
+        Choice choice = {};
+        choice.key = make_header(key);
+        choice.candidates = candidates;
+        choice.min_solution = target.min_solution;
+        choice.min_dead_ends = target.min_dead_ends;
+        return choice;
+    }
 
-    chrono::time_point start = chrono::high_resolution_clock::now();
+    filesystem::path choice_path(const filesystem::path& directory, const Choice& choice) {
+        uint64_t hash = fnv1a(0xCBF29CE484222325, &choice, offsetof(Choice, index));
 
-    while (true) {
-        offset = game::input();
-        new_matrix = game::update_matrix(map, old_matrix, player_location, offset);
+        ostringstream name;
+        name << hex << setw(16) << setfill('0') << hash << ".select";
+        return directory / name.str();
+    }
+
+    size_t packed_size(const Key& key) {
+        return (static_cast<size_t>(key.rows) * key.cols + 7) / 8;
+    }
+
+    bool load(
+            const filesystem::path& directory, const Key& key,
+            vector<vector<char>>& maze, pair<int, int>& end_cell, int& max_dist
+    ) {
+        filesystem::path path = entry_path(directory, key);
 
-        if (offset == pair<int, int>{2, 2}) break;
+        HANDLE file = CreateFileA(
+                path.string().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+        );
+        if (file == INVALID_HANDLE_VALUE) return false;
 
-        if (new_matrix != old_matrix) {
-            render::render(old_matrix, new_matrix, false);
-            old_matrix = new_matrix;
+        LARGE_INTEGER size;
+        HANDLE mapping = nullptr;
+        const void* view = nullptr;
 
-            moves++;
+        if (GetFileSizeEx(file, &size) && static_cast<size_t>(size.QuadPart) == sizeof(Header) + packed_size(key)) {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping) view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
         }
 
-        if (player_location == end_cell) {
-            chrono::time_point end = chrono::high_resolution_clock::now();
-            chrono::duration duration = end - start;
-            int64_t total_seconds = chrono::duration_cast<chrono::seconds>(duration).count();
+        Header expected = make_header(key);
+        Header header = {};
+        if (view) memcpy(&header, view, sizeof(Header));
+
+        bool hit = view &&
+                memcmp(&header, &expected, offsetof(Header, end_r)) == 0 &&
+                header.algorithm == expected.algorithm &&
+                header.end_r > 0 && header.end_c > 0 &&
+                static_cast<uint32_t>(header.end_r) < key.rows && static_cast<uint32_t>(header.end_c) < key.cols;
+
+        if (hit) {
+            const auto* bits = static_cast<const uint8_t*>(view) + sizeof(Header);
+
+            maze.resize(key.rows);
+            size_t index = 0;
+            for (auto& row : maze) {
+                row.resize(key.cols);
+                for (auto& tile : row) {
+                    tile = (bits[index / 8] >> (index % 8)) & 1 ? map::TILE_WALL : map::TILE_PATH;
+                    ++index;
+                }
+            }
 
-            int64_t minutes = (total_seconds % 3600) / 60;
-            int64_t seconds = total_seconds % 60;
+            end_cell = {header.end_r, header.end_c};
+            max_dist = header.max_dist;
+            maze[end_cell.first][end_cell.second] = map::TILE_GOAL;
+        }
 
-            int moves_per_second = static_cast<int>(round(moves / total_seconds));
+        if (view) UnmapViewOfFile(view);
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
 
-            cout << "You finished!\n"
-                 << "=====================\n"
-                 << "Total Time  : " << minutes << "m " << seconds << "s\n"
-                 << "Total Moves : " << moves << "\n"
-                 << "Min. Moves  : " << max_dist << "\n"
-                 << "Moves / s   : " << moves_per_second << "\n"
-                 << "=====================\n";
+        // Reads refresh the modification time, which is what eviction orders by
+        if (hit) {
+            error_code error;
+            filesystem::last_write_time(path, filesystem::file_time_type::clock::now(), error);
+        }
 
-            break;
+        return hit;
+    }
+
+    bool temporary(const filesystem::path& path) {
+        return path.extension().string().starts_with(".tmp");
+    }
+
+    /*
+     * Drops least recently used entries until the directory fits in `budget` bytes, never the
+     * `keep` entry that was just written. Temporary files count against the budget too; one older
+     * than STALE_TEMPORARY belongs to a writer that died before renaming it and is deleted.
+     */
+    void evict(const filesystem::path& directory, uintmax_t budget, const filesystem::path& keep = {}) {
+        vector<tuple<filesystem::file_time_type, uintmax_t, filesystem::path>> entries;
+        uintmax_t total = 0;
+        filesystem::file_time_type now = filesystem::file_time_type::clock::now();
+
+        error_code error;
+        for (const auto& entry : filesystem::directory_iterator(directory, error)) {
+            const filesystem::path& path = entry.path();
+            bool partial = temporary(path);
+            if (!partial && path.extension() != ".maze" && path.extension() != ".select") continue;
+
+            uintmax_t size = entry.file_size(error);
+            if (error) continue;
+            filesystem::file_time_type time = entry.last_write_time(error);
+            if (error) continue;
+
+            if (partial && now - time > STALE_TEMPORARY && filesystem::remove(path, error)) continue;
+
+            total += size;
+            if (!partial && path != keep) entries.emplace_back(time, size, path);
+        }
+
+        sort(entries.begin(), entries.end());
+
+        for (const auto& [time, size, path] : entries) {
+            if (total <= budget) break;
+            if (filesystem::remove(path, error)) total -= size;
         }
     }
 
-    cout << "Press enter to exit" << endl;
+    /*
+     * Writes under a unique temporary name and renames into place, so readers and other writers
+     * only ever see complete files. Losing the rename race to another writer is fine since both
+     * wrote the same bytes.
+     */
+    bool replace(const filesystem::path& path, initializer_list<pair<const void*, size_t>> parts) {
+        error_code error;
+        filesystem::path temporary = path;
+        temporary += ".tmp" + to_string(random_device{}());
+
+        {
+            ofstream out(temporary, ios::binary);
+            for (auto [data, size] : parts) out.write(static_cast<const char*>(data), static_cast<streamsize>(size));
+
+            if (!out) {
+                out.close();
+                filesystem::remove(temporary, error);
+                return false;
+            }
+        }
 
-    terminal::deinit();
+        filesystem::rename(temporary, path, error);
+        if (error) filesystem::remove(temporary, error);
+        return true;
+    }
 
-    cin.get();
+    bool store(
+            const filesystem::path& directory, const Key& key, uintmax_t budget,
+            const vector<vector<char>>& maze, const pair<int, int>& end_cell, int max_dist
+    ) {
+        error_code error;
+        filesystem::create_directories(directory, error);
+
+        Header header = make_header(key);
+        header.end_r = end_cell.first;
+        header.end_c = end_cell.second;
+        header.max_dist = max_dist;
+
+        vector<uint8_t> bits(packed_size(key), 0);
+        size_t index = 0;
+        for (const auto& row : maze) {
+            for (char tile : row) {
+                if (tile == map::TILE_WALL) bits[index / 8] |= 1 << (index % 8);
+                ++index;
+            }
+        }
+
+        filesystem::path path = entry_path(directory, key);
+        if (!replace(path, {{&header, sizeof(header)}, {bits.data(), bits.size()}})) return false;
+
+        evict(directory, budget, path);
+        return true;
+    }
+
+    bool load_choice(
+            const filesystem::path& directory, const Key& key, size_t candidates, const selection::Target& target,
+            selection::Result& result
+    ) {
+        Choice expected = make_choice(key, candidates, target);
+        filesystem::path path = choice_path(directory, expected);
+
+        Choice choice = {};
+        ifstream in(path, ios::binary);
+        if (!in.read(reinterpret_cast<char*>(&choice), sizeof(choice))) return false;
+        if (memcmp(&choice, &expected, offsetof(Choice, index)) != 0 || choice.index >= candidates) return false;
+
+        result.seed = choice.seed;
+        result.index = choice.index;
+        result.qualified = choice.qualified;
+
+        error_code error;
+        filesystem::last_write_time(path, filesystem::file_time_type::clock::now(), error);
+        return true;
+    }
+
+    bool store_choice(
+            const filesystem::path& directory, const Key& key, size_t candidates, const selection::Target& target,
+            const selection::Result& result
+    ) {
+        error_code error;
+        filesystem::create_directories(directory, error);
+
+        Choice choice = make_choice(key, candidates, target);
+        choice.index = result.index;
+        choice.seed = result.seed;
+        choice.qualified = result.qualified;
+
+        return replace(choice_path(directory, choice), {{&choice, sizeof(choice)}});
+    }
+}
+
+namespace overview {
+    enum Glyph {
+        None,
+        Quadrant,
+        Sextant
+    };
+
+    // Tiles per character, columns by rows
+    constexpr int BLOCK_WIDTH = 2;
+
+    int block_height(Glyph glyph) {
+        return glyph == Sextant ? 3 : 2;
+    }
+
+    string utf8(char32_t code_point) {
+        string out;
+        if (code_point < 0x80) {
+            out += static_cast<char>(code_point);
+        } else if (code_point < 0x800) {
+            out += static_cast<char>(0xC0 | (code_point >> 6));
+            out += static_cast<char>(0x80 | (code_point & 0x3F));
+        } else if (code_point < 0x10000) {
+            out += static_cast<char>(0xE0 | (code_point >> 12));
+            out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code_point & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code_point >> 18));
+            out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+        return out;
+    }
+
+    // Indexed by a mask of foreground tiles, bit 0 top left, then left to right and top to bottom
+    const array<string, 16> quadrants = {
+            " ", "▘", "▝", "▀", "▖", "▌", "▞", "▛", "▗", "▚", "▐", "▜", "▄", "▙", "▟", "█"
+    };
+
+    // Legacy computing sextants skip the two patterns that already exist as half blocks
+    const array<string, 64> sextants = [] {
+        array<string, 64> glyphs;
+        glyphs[0] = " ";
+        glyphs[21] = "▌";
+        glyphs[42] = "▐";
+        glyphs[63] = "█";
+
+        for (int mask = 1; mask < 63; ++mask) {
+            if (mask == 21 || mask == 42) continue;
+            glyphs[mask] = utf8(0x1FB00 + mask - 1 - (mask > 21) - (mask > 42));
+        }
+
+        return glyphs;
+    }();
+
+    /*
+     * levels[k] is the board downsampled 2^(k+1) times. A downsampled tile shows the player or
+     * goal if any tile below it does, otherwise it is a path when most of its tiles are.
+     */
+    struct View {
+        Glyph glyph = None;
+        int level = 0;
+        vector<vector<vector<char>>> levels;
+
+        // Number of the last draw_cells pass that painted each character, for skipping repeats
+        size_t columns = 0;
+        vector<uint32_t> painted;
+        uint32_t pass = 0;
+    };
+
+    const vector<vector<char>>& source(const View& view, const vector<vector<char>>& matrix) {
+        return view.level == 0 ? matrix : view.levels[view.level - 1];
+    }
+
+    // Which tile survives when several share a block or a character: player, then goal, then hint
+    int priority(char tile) {
+        switch (tile) {
+            case map::TILE_PLAYER:
+                return 3;
+            case map::TILE_GOAL:
+                return 2;
+            case map::TILE_HINT:
+                return 1;
+            default:
+                return 0;
+        }
+    }
+
+    char downsample(const vector<vector<char>>& below, size_t r, size_t c) {
+        int tiles = 0, paths = 0;
+        char special = 0;
+
+        for (size_t br = r * 2; br < min(r * 2 + 2, below.size()); ++br) {
+            for (size_t bc = c * 2; bc < min(c * 2 + 2, below[br].size()); ++bc) {
+                char tile = below[br][bc];
+                tiles++;
+                paths += tile != map::TILE_WALL;
+                if (priority(tile) > priority(special)) special = tile;
+            }
+        }
+
+        if (special) return special;
+
+        // Half-open blocks are common in a perfect maze, so ties alternate instead of washing out
+        bool path = paths * 2 > tiles || (paths * 2 == tiles && (r + c) % 2 == 0);
+        return path ? map::TILE_PATH : map::TILE_WALL;
+    }
+
+    // Picks the smallest level whose glyphs fit in the given number of lines and columns
+    void build(View& view, const vector<vector<char>>& matrix, Glyph glyph, size_t lines, size_t columns) {
+        view.glyph = glyph;
+        view.level = 0;
+        view.levels.clear();
+
+        const vector<vector<char>>* below = &matrix;
+        auto fits = [&](const vector<vector<char>>& level) {
+            size_t height = (level.size() + block_height(glyph) - 1) / block_height(glyph);
+            size_t width = (level[0].size() + BLOCK_WIDTH - 1) / BLOCK_WIDTH;
+            return height <= lines && width <= columns;
+        };
+
+        while (!fits(*below) && (below->size() > 1 || (*below)[0].size() > 1)) {
+            vector<vector<char>> level((below->size() + 1) / 2, vector<char>(((*below)[0].size() + 1) / 2));
+            for (size_t r = 0; r < level.size(); ++r) {
+                for (size_t c = 0; c < level[r].size(); ++c) level[r][c] = downsample(*below, r, c);
+            }
+
+            view.levels.push_back(std::move(level));
+            view.level++;
+            below = &view.levels.back();
+        }
+
+        view.columns = ((*below)[0].size() + BLOCK_WIDTH - 1) / BLOCK_WIDTH;
+        view.painted.assign((below->size() + block_height(glyph) - 1) / block_height(glyph) * view.columns, 0);
+        view.pass = 0;
+    }
+
+    // Refreshes the downsampled tiles above changed cells, one tile per level each
+    void update(View& view, const vector<vector<char>>& matrix, span<const pair<int, int>> cells) {
+        for (auto [r, c] : cells) {
+            size_t row = r, col = c;
+            for (int k = 0; k < view.level; ++k) {
+                row /= 2;
+                col /= 2;
+                view.levels[k][row][col] = downsample(k == 0 ? matrix : view.levels[k - 1], row, col);
+            }
+        }
+    }
+
+    void render_glyph(string& out, const View& view, const vector<vector<char>>& tiles, size_t line, size_t column) {
+        int height = block_height(view.glyph);
+        int walls = 0, paths = 0;
+        char special = 0;
+
+        for (int dr = 0; dr < height; ++dr) {
+            for (int dc = 0; dc < BLOCK_WIDTH; ++dc) {
+                size_t r = line * height + dr, c = column * BLOCK_WIDTH + dc;
+                if (r >= tiles.size() || c >= tiles[r].size()) continue;
+
+                char tile = tiles[r][c];
+                if (tile == map::TILE_WALL) walls++;
+                else if (tile == map::TILE_PATH) paths++;
+                else if (priority(tile) > priority(special)) special = tile;
+            }
+        }
+
+        // Two colours per character: the player or goal takes the foreground from the walls
+        char fg = special ? special : map::TILE_WALL;
+        char bg = special && walls > paths ? map::TILE_WALL : map::TILE_PATH;
+
+        int mask = 0;
+        for (int dr = 0; dr < height; ++dr) {
+            for (int dc = 0; dc < BLOCK_WIDTH; ++dc) {
+                size_t r = line * height + dr, c = column * BLOCK_WIDTH + dc;
+                if (r < tiles.size() && c < tiles[r].size() && tiles[r][c] == fg) mask |= 1 << (dr * BLOCK_WIDTH + dc);
+            }
+        }
+
+        out += render::fg(fg);
+        out += render::bg(bg);
+        out += view.glyph == Sextant ? sextants[mask] : quadrants[mask];
+    }
+
+    size_t lines(const View& view, const vector<vector<char>>& matrix) {
+        return (source(view, matrix).size() + block_height(view.glyph) - 1) / block_height(view.glyph);
+    }
+
+    void draw(const View& view, const vector<vector<char>>& matrix) {
+        stats::Scope scope(stats::Render);
+        string& out = render::buffer();
+        const vector<vector<char>>& tiles = source(view, matrix);
+
+        size_t columns = (tiles[0].size() + BLOCK_WIDTH - 1) / BLOCK_WIDTH;
+        for (size_t line = 0; line < lines(view, matrix); ++line) {
+            for (size_t column = 0; column < columns; ++column) render_glyph(out, view, tiles, line, column);
+            out += render::RESET;
+            out += '\n';
+        }
+
+        render::flush(out);
+    }
+
+    // Like render::render_cells, repaints only the characters covering the changed cells
+    void draw_cells(View& view, const vector<vector<char>>& matrix, span<const pair<int, int>> cells) {
+        stats::Scope scope(stats::Render);
+        update(view, matrix, cells);
+
+        string& out = render::buffer();
+        const vector<vector<char>>& tiles = source(view, matrix);
+        int total = static_cast<int>(lines(view, matrix));
+
+        // Generation hands over whole boards at once, which are cheaper to draw from the top
+        if (cells.size() >= view.painted.size()) {
+            render::up(total, out);
+            render::flush(out);
+            draw(view, matrix);
+            return;
+        }
+
+        if (++view.pass == 0) {
+            fill(view.painted.begin(), view.painted.end(), 0);
+            view.pass = 1;
+        }
+
+        auto character = [&](const pair<int, int>& cell) {
+            return pair<size_t, size_t>{
+                    (static_cast<size_t>(cell.first) >> view.level) / block_height(view.glyph),
+                    (static_cast<size_t>(cell.second) >> view.level) / BLOCK_WIDTH
+            };
+        };
+
+        for (const auto& cell : cells) {
+            auto [line, column] = character(cell);
+
+            uint32_t& stamp = view.painted[line * view.columns + column];
+            if (stamp == view.pass) continue;
+            stamp = view.pass;
+
+            int distance = total - static_cast<int>(line);
+
+            render::up(distance, out);
+            if (column > 0) render::right(static_cast<int>(column), out);
+            render_glyph(out, view, tiles, line, column);
+            out += render::RESET;
+            out += '\r';
+            render::down(distance, out);
+        }
+
+        render::flush(out);
+    }
+}
+
+namespace game {
+    const unordered_set<char> solids = {map::TILE_WALL};
+
+    enum Key {
+        ArrowPrefix = 224,
+        CtrlC = 3,
+        Up = 72,
+        Down = 80,
+        Left = 75,
+        Right = 77,
+        PageUp = 73,
+        PageDown = 81,
+        Backspace = 8,
+        CtrlY = 25,
+        Hint = 'h'
+    };
+
+    constexpr int SCRUB_STEP = 50;
+
+    const pair<int, int> EXIT_CODE = {2, 2};
+    constexpr int REWIND_CODE = 3;
+    constexpr int FORWARD_CODE = 4;
+    const pair<int, int> HINT_CODE = {5, 0};
+
+    constexpr chrono::milliseconds POLL_INTERVAL(10);
+
+    struct Options {
+        unsigned int rows = 45;
+        unsigned int cols = 45;
+        unsigned int seed = random_device{}();
+        selection::Target target;
+        size_t candidates = 64;
+        unsigned int threads = max(1u, thread::hardware_concurrency());
+        string cache;
+        uintmax_t cache_budget = cache::DEFAULT_BUDGET;
+        overview::Glyph overview = overview::None;
+        string feed;
+        string stats;
+    };
+
+    bool parse(int argc, char* argv[], int first, Options& options) {
+        vector<pair<string, string>> pairs;
+        if (!cli::options(argc, argv, first, pairs)) return false;
+
+        for (const auto& [arg, value] : pairs) {
+            try {
+                if (arg == "--size") {
+                    pair<unsigned int, unsigned int> size;
+                    if (!cli::parse_size(value, size)) throw invalid_argument(value);
+                    tie(options.rows, options.cols) = size;
+                } else if (arg == "--seed") {
+                    options.seed = stoul(value);
+                } else if (arg == "--min-solution") {
+                    options.target.min_solution = stod(value);
+                } else if (arg == "--min-dead-ends") {
+                    options.target.min_dead_ends = stod(value);
+                } else if (arg == "--candidates") {
+                    options.candidates = max(1ul, stoul(value));
+                } else if (arg == "--threads") {
+                    options.threads = max(1ul, stoul(value));
+                } else if (arg == "--cache") {
+                    options.cache = value;
+                } else if (arg == "--cache-budget") {
+                    options.cache_budget = static_cast<uintmax_t>(stoull(value)) << 20;
+                } else if (arg == "--overview") {
+                    if (value == "quadrant") options.overview = overview::Quadrant;
+                    else if (value == "sextant") options.overview = overview::Sextant;
+                    else throw invalid_argument(value);
+                } else if (arg == "--feed") {
+                    options.feed = value;
+                } else if (arg == "--stats") {
+                    options.stats = value;
+                } else {
+                    cerr << "Unknown option " << arg << endl;
+                    return false;
+                }
+            } catch (const exception&) {
+                cerr << "Invalid value for " << arg << ": " << value << endl;
+                return false;
+            }
+        }
+
+        return cli::valid_size(options.rows, options.cols);
+    }
+
+    bool has_target(const Options& options) {
+        return options.target.min_solution > 0 || options.target.min_dead_ends > 0;
+    }
+
+    // Whether any option is set that only means something while playing
+    bool plays(const Options& options) {
+        return !options.cache.empty() || options.cache_budget != cache::DEFAULT_BUDGET || !options.feed.empty() ||
+               options.overview != overview::None || !options.stats.empty();
+    }
+
+    // Moves and repaints are expected to stay free of allocations once the game is running
+    struct Usage {
+        uint64_t moves = 0;
+        uint64_t allocating_moves = 0;
+        uint64_t frames = 0;
+        uint64_t allocating_frames = 0;
+    };
+
+    bool regressed(const Usage& usage) {
+        return usage.allocating_moves > 0 || usage.allocating_frames > 0;
+    }
+
+    void report(ostream& out, const Usage& usage) {
+        if (!stats::ENABLED) {
+            out << "Allocation stats are compiled out, configure with -DLEMAZE_STATS=ON\n";
+            return;
+        }
+
+        out << "Memory\n"
+            << "=====================\n"
+            << left << setw(10) << "Subsystem" << right << setw(12) << "Allocs" << setw(12) << "Frees"
+            << setw(14) << "Bytes" << setw(14) << "Peak live" << "\n";
+
+        for (size_t i = 0; i < stats::TAGS; ++i) {
+            auto tag = static_cast<stats::Tag>(i);
+            out << left << setw(10) << stats::names[tag] << right << setw(12) << stats::allocations(tag)
+                << setw(12) << stats::frees(tag) << setw(14) << stats::bytes(tag) << setw(14) << stats::peak(tag) << "\n";
+        }
+
+        out << "Peak RSS  : " << stats::peak_rss() / 1024 << " KiB\n"
+            << "Moves     : " << usage.moves << " (" << usage.allocating_moves << " allocating)\n"
+            << "Frames    : " << usage.frames << " (" << usage.allocating_frames << " allocating)\n";
+
+        if (regressed(usage)) out << "Moves and frames are expected not to allocate, exiting with " << stats::REGRESSION_EXIT_CODE << "\n";
+
+        out << "=====================\n";
+    }
+
+    // Applies the passages published so far into `carved` and returns true once the goal has been placed
+    bool apply_progress(
+            map::Progress& progress,
+            vector<vector<char>>& map,
+            vector<vector<char>>& matrix,
+            vector<pair<int, int>>& carved,
+            pair<int, int>& end_cell,
+            int& max_dist
+    ) {
+        bool done;
+        {
+            lock_guard guard(progress.lock);
+            carved.swap(progress.carved);
+            done = progress.done;
+            end_cell = progress.end_cell;
+            max_dist = progress.max_dist;
+        }
+
+        for (auto [r, c] : carved) {
+            map[r][c] = map::TILE_PATH;
+            matrix[r][c] = map::TILE_PATH;
+        }
+
+        if (done) {
+            map[end_cell.first][end_cell.second] = map::TILE_GOAL;
+            if (matrix[end_cell.first][end_cell.second] != map::TILE_PLAYER) {
+                matrix[end_cell.first][end_cell.second] = map::TILE_GOAL;
+            }
+            carved.push_back(end_cell);
+        }
+
+        return done;
+    }
+
+    // Moves the player in place, returning false if the move was blocked
+    bool update_matrix(
+            const vector<vector<char>>& map,
+            vector<vector<char>>& matrix,
+            pair<int, int>& player_location,
+            const pair<int, int>& offset
+    ) {
+        int x = player_location.first;
+        int y = player_location.second;
+
+        int new_x = x + offset.first;
+        int new_y = y + offset.second;
+
+        if (new_x < 0 || new_y < 0) return false;
+        if (new_x > matrix.size() - 1 || new_y > matrix[0].size() - 1) return false;
+        if (offset == pair{0, 0} || solids.contains(matrix[new_x][new_y])) return false;
+
+        matrix[x][y] = map[x][y];
+        matrix[new_x][new_y] = map::TILE_PLAYER;
+
+        player_location = {new_x, new_y};
+
+        return true;
+    }
+
+    pair<int, int> input() {
+        int ch = _getch();
+        if (ch == ArrowPrefix) {
+            pair<int, int> offset = {0, 0};
+
+            switch (_getch()) {
+                case Up:
+                    offset.first -= 1;
+                    break;
+                case Down:
+                    offset.first += 1;
+                    break;
+                case Left:
+                    offset.second -= 1;
+                    break;
+                case Right:
+                    offset.second += 1;
+                    break;
+                case PageUp:
+                    offset = {REWIND_CODE, SCRUB_STEP};
+                    break;
+                case PageDown:
+                    offset = {FORWARD_CODE, SCRUB_STEP};
+                    break;
+            }
+
+            return offset;
+        } else if (ch == CtrlC) {
+            return EXIT_CODE;
+        } else if (ch == Backspace) {
+            return {REWIND_CODE, 1};
+        } else if (ch == CtrlY) {
+            return {FORWARD_CODE, 1};
+        } else if (ch == Hint) {
+            return HINT_CODE;
+        }
+
+        return {0, 0};
+    }
+}
+
+namespace history {
+    // Player position is stored every CHECKPOINT_INTERVAL moves, everything in between is 2 bits a move
+    constexpr size_t CHECKPOINT_INTERVAL = 4096;
+    constexpr size_t MOVES_PER_WORD = 32;
+
+    // Room reserved up front so recording a move does not allocate in any ordinary game
+    constexpr size_t RESERVED_MOVES = 1 << 16;
+
+    enum Move : uint8_t {
+        MoveUp = 0,
+        MoveDown = 1,
+        MoveLeft = 2,
+        MoveRight = 3
+    };
+
+    struct Log {
+        vector<uint64_t> words;
+        vector<pair<int, int>> checkpoints;
+        size_t length = 0;
+        size_t cursor = 0;
+    };
+
+    uint8_t encode(const pair<int, int>& offset) {
+        if (offset.first < 0) return MoveUp;
+        if (offset.first > 0) return MoveDown;
+        if (offset.second < 0) return MoveLeft;
+        return MoveRight;
+    }
+
+    pair<int, int> decode(uint8_t move) {
+        switch (move) {
+            case MoveUp:
+                return {-1, 0};
+            case MoveDown:
+                return {1, 0};
+            case MoveLeft:
+                return {0, -1};
+            default:
+                return {0, 1};
+        }
+    }
+
+    void reset(Log& log, const pair<int, int>& start) {
+        log.words.clear();
+        log.words.reserve(RESERVED_MOVES / MOVES_PER_WORD);
+        log.checkpoints.reserve(RESERVED_MOVES / CHECKPOINT_INTERVAL + 1);
+        log.checkpoints.assign(1, start);
+        log.length = 0;
+        log.cursor = 0;
+    }
+
+    uint8_t at(const Log& log, size_t index) {
+        return (log.words[index / MOVES_PER_WORD] >> (index % MOVES_PER_WORD * 2)) & 0b11;
+    }
+
+    // Appends a move at the cursor, dropping any moves that were rewound past
+    void record(Log& log, const pair<int, int>& offset, const pair<int, int>& destination) {
+        if (log.cursor < log.length) {
+            log.length = log.cursor;
+            log.words.resize((log.length + MOVES_PER_WORD - 1) / MOVES_PER_WORD);
+            log.checkpoints.resize(log.length / CHECKPOINT_INTERVAL + 1);
+        }
+
+        size_t index = log.length;
+        size_t shift = index % MOVES_PER_WORD * 2;
+
+        if (index / MOVES_PER_WORD >= log.words.size()) log.words.push_back(0);
+
+        uint64_t& word = log.words[index / MOVES_PER_WORD];
+        word = (word & ~(uint64_t{0b11} << shift)) | (uint64_t{encode(offset)} << shift);
+
+        log.length++;
+        log.cursor = log.length;
+
+        if (log.length % CHECKPOINT_INTERVAL == 0) log.checkpoints.push_back(destination);
+    }
+
+    pair<int, int> position_at(const Log& log, size_t index) {
+        size_t checkpoint = index / CHECKPOINT_INTERVAL;
+        pair<int, int> position = log.checkpoints[checkpoint];
+
+        for (size_t i = checkpoint * CHECKPOINT_INTERVAL; i < index; ++i) {
+            auto [dr, dc] = decode(at(log, i));
+            position.first += dr;
+            position.second += dc;
+        }
+
+        return position;
+    }
+
+    // Moves the cursor by up to `steps` moves and returns the player position there
+    pair<int, int> rewind(Log& log, size_t steps) {
+        log.cursor -= min(steps, log.cursor);
+        return position_at(log, log.cursor);
+    }
+
+    pair<int, int> forward(Log& log, size_t steps) {
+        log.cursor += min(steps, log.length - log.cursor);
+        return position_at(log, log.cursor);
+    }
+}
+
+namespace guide {
+    constexpr size_t HINT_LENGTH = 8;
+
+    // Direction of the next step towards the goal for every open tile, 2 bits each in row-major order
+    struct Field {
+        size_t cols = 0;
+        vector<uint8_t> bits;
+    };
+
+    uint8_t step(const Field& field, const pair<int, int>& position) {
+        size_t index = position.first * field.cols + position.second;
+        return (field.bits[index / 4] >> (index % 4 * 2)) & 0b11;
+    }
+
+    pair<int, int> next(const Field& field, const pair<int, int>& position) {
+        auto [dr, dc] = history::decode(step(field, position));
+        return {position.first + dr, position.second + dc};
+    }
+
+    // Reverse BFS from the goal, each tile points back at the tile it was reached from
+    void build(Field& field, const vector<vector<char>>& maze, const pair<int, int>& end_cell) {
+        size_t rows = maze.size(), cols = maze[0].size();
+
+        field.cols = cols;
+        field.bits.assign((rows * cols + 3) / 4, 0);
+
+        vector<bool> visited(rows * cols, false);
+        vector<pair<int, int>> q = {end_cell};
+        visited[end_cell.first * cols + end_cell.second] = true;
+
+        for (size_t head = 0; head < q.size(); ++head) {
+            auto [r, c] = q[head];
+
+            for (uint8_t move = history::MoveUp; move <= history::MoveRight; ++move) {
+                auto [dr, dc] = history::decode(move);
+                int nr = r + dr, nc = c + dc;
+
+                if (nr < 0 || nc < 0 || nr >= static_cast<int>(rows) || nc >= static_cast<int>(cols)) continue;
+
+                size_t index = nr * cols + nc;
+                if (visited[index] || maze[nr][nc] == map::TILE_WALL) continue;
+
+                // Up and down, left and right differ only in the lowest bit
+                visited[index] = true;
+                field.bits[index / 4] |= (move ^ 1) << (index % 4 * 2);
+                q.emplace_back(nr, nc);
+            }
+        }
+    }
+
+    // Only needed after jumps such as rewinds, single moves adjust the distance by one
+    int distance(const Field& field, pair<int, int> position, const pair<int, int>& end_cell) {
+        int steps = 0;
+        for (; position != end_cell; ++steps) position = next(field, position);
+        return steps;
+    }
+
+    // In a perfect maze every move either follows the field or adds one step to the way back
+    int moved(const Field& field, int to_goal, const pair<int, int>& from, const pair<int, int>& to) {
+        return next(field, from) == to ? to_goal - 1 : to_goal + 1;
+    }
+
+    vector<pair<int, int>> hint(const Field& field, pair<int, int> position, const pair<int, int>& end_cell) {
+        vector<pair<int, int>> cells;
+        while (position != end_cell && cells.size() < HINT_LENGTH) {
+            position = next(field, position);
+            if (position != end_cell) cells.push_back(position);
+        }
+        return cells;
+    }
+}
+
+namespace batch {
+    struct Options {
+        vector<string> algorithms = {"backtracker"};
+        vector<pair<unsigned int, unsigned int>> sizes = {{45, 45}};
+        unsigned int first_seed = 0;
+        unsigned int last_seed = 99;
+        unsigned int threads = max(1u, thread::hardware_concurrency());
+        string output;
+    };
+
+    struct Job {
+        size_t algorithm;
+        unsigned int rows, cols, seed;
+    };
+
+    bool parse(int argc, char* argv[], Options& options) {
+        vector<pair<string, string>> pairs;
+        if (!cli::options(argc, argv, 2, pairs)) return false;
+
+        for (const auto& [arg, value] : pairs) {
+            try {
+                if (arg == "--algorithms") {
+                    options.algorithms = cli::split(value, ',');
+                } else if (arg == "--sizes") {
+                    options.sizes.clear();
+
+                    for (const auto& text : cli::split(value, ',')) {
+                        pair<unsigned int, unsigned int> size;
+                        if (!cli::parse_size(text, size)) throw invalid_argument(text);
+                        options.sizes.push_back(size);
+                    }
+                } else if (arg == "--seeds") {
+                    size_t dash = value.find('-');
+                    options.first_seed = stoul(value.substr(0, dash));
+                    options.last_seed = dash == string::npos ? options.first_seed : stoul(value.substr(dash + 1));
+                } else if (arg == "--threads") {
+                    options.threads = max(1ul, stoul(value));
+                } else if (arg == "--output") {
+                    options.output = value;
+                } else {
+                    cerr << "Unknown option " << arg << endl;
+                    return false;
+                }
+            } catch (const exception&) {
+                cerr << "Invalid value for " << arg << ": " << value << endl;
+                return false;
+            }
+        }
+
+        for (const auto& algorithm : options.algorithms) {
+            if (find(map::algorithms.begin(), map::algorithms.end(), algorithm) == map::algorithms.end()) {
+                cerr << "Unknown algorithm " << algorithm << endl;
+                return false;
+            }
+        }
+
+        for (auto [rows, cols] : options.sizes) {
+            if (!cli::valid_size(rows, cols)) return false;
+        }
+
+        if (options.last_seed < options.first_seed) {
+            cerr << "Seed range is empty" << endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    void write_row(ostream& out, const Job& job, const analysis::Metrics& metrics) {
+        out << map::algorithms[job.algorithm] << ',' << job.rows << ',' << job.cols << ',' << job.seed << ','
+            << metrics.cells << ',' << metrics.dead_ends << ',' << metrics.junctions << ','
+            << metrics.river_factor << ',' << metrics.solution_length << ',';
+
+        bool first = true;
+        for (size_t length = 0; length < metrics.corridor_lengths.size(); ++length) {
+            if (metrics.corridor_lengths[length] == 0) continue;
+            if (!first) out << ';';
+            out << length << ':' << metrics.corridor_lengths[length];
+            first = false;
+        }
+
+        out << '\n';
+    }
+
+    int run(const Options& options) {
+        vector<Job> jobs;
+        for (size_t algorithm = 0; algorithm < map::algorithms.size(); ++algorithm) {
+            if (find(options.algorithms.begin(), options.algorithms.end(), map::algorithms[algorithm]) == options.algorithms.end()) continue;
+
+            for (auto [rows, cols] : options.sizes) {
+                for (unsigned int seed = options.first_seed;; ++seed) {
+                    jobs.push_back({algorithm, rows, cols, seed});
+                    if (seed == options.last_seed) break;
+                }
+            }
+        }
+
+        vector<string> rows(jobs.size());
+        atomic<size_t> next = 0;
+
+        auto worker = [&]() {
+            stats::Scope scope(stats::Map);
+            map::Workspace ws;
+            analysis::Metrics metrics;
+            ostringstream row;
+
+            for (size_t i = next++; i < jobs.size(); i = next++) {
+                const Job& job = jobs[i];
+
+                auto [end_cell, max_dist] = map::generate_maze(ws, job.rows, job.cols, {1, 1}, job.seed);
+                analysis::analyse(ws.maze, max_dist, metrics);
+
+                row.str("");
+                write_row(row, job, metrics);
+                rows[i] = row.str();
+            }
+        };
+
+        vector<thread> workers;
+        for (unsigned int i = 0; i < min<size_t>(options.threads, jobs.size()); ++i) workers.emplace_back(worker);
+        for (auto& w : workers) w.join();
+
+        ofstream file;
+        if (!options.output.empty()) {
+            file.open(options.output);
+            if (!file) {
+                cerr << "Could not open " << options.output << endl;
+                return 1;
+            }
+        }
+
+        ostream& out = options.output.empty() ? cout : file;
+
+        out << "algorithm,rows,cols,seed,cells,dead_ends,junctions,river_factor,solution_length,corridor_lengths\n";
+        for (const auto& row : rows) out << row;
+
+        return 0;
+    }
+}
+
+namespace image {
+    // Tile colours, indexed by the tile digit
+    constexpr array<array<uint8_t, 3>, 4> palette = {{
+            {0, 0, 0},
+            {255, 255, 255},
+            {255, 0, 0},
+            {255, 255, 0}
+    }};
+
+    constexpr size_t CHUNK_SIZE = 1 << 16;
+
+    struct Options {
+        string output;
+        string input;
+        unsigned int rows = 45;
+        unsigned int cols = 45;
+        unsigned int seed = random_device{}();
+        unsigned int scale = 4;
+    };
+
+    // Produces the maze one row at a time so exports never hold more than a row
+    struct Source {
+        size_t rows = 0, cols = 0;
+        function<bool(string&)> next_row;
+    };
+
+    Source grid_source(const vector<vector<char>>& maze) {
+        auto row = make_shared<size_t>(0);
+
+        return {maze.size(), maze[0].size(), [&maze, row](string& out) {
+            if (*row >= maze.size()) return false;
+            out.assign(maze[*row].begin(), maze[*row].end());
+            ++*row;
+            return true;
+        }};
+    }
+
+    bool tile_index(char tile, uint8_t& index) {
+        if (tile < map::TILE_PATH || tile > map::TILE_GOAL) {
+            cerr << "Invalid tile '" << tile << "'" << endl;
+            return false;
+        }
+
+        index = static_cast<uint8_t>(tile - map::TILE_PATH);
+        return true;
+    }
+
+    // Reads a text maze (one line per row, tile digits) in two passes: one that checks the tiles and
+    // measures the size before any output exists, and one for the rows
+    bool stream_source(ifstream& in, Source& source) {
+        string line;
+        while (getline(in, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+
+            if (source.cols != 0 && line.size() != source.cols) {
+                cerr << "Maze rows have different lengths" << endl;
+                return false;
+            }
+
+            uint8_t index;
+            for (char tile : line) {
+                if (!tile_index(tile, index)) return false;
+            }
+
+            source.cols = line.size();
+            source.rows++;
+        }
+
+        if (source.rows == 0) {
+            cerr << "Maze file is empty" << endl;
+            return false;
+        }
+
+        in.clear();
+        in.seekg(0);
+
+        source.next_row = [&in](string& out) {
+            while (getline(in, out)) {
+                if (!out.empty() && out.back() == '\r') out.pop_back();
+                if (!out.empty()) return true;
+            }
+            return false;
+        };
+
+        return true;
+    }
+
+    bool write_ppm(ostream& out, Source& source, unsigned int scale) {
+        out << "P6\n" << source.cols * scale << " " << source.rows * scale << "\n255\n";
+
+        string row;
+        vector<char> line(source.cols * scale * 3);
+
+        while (source.next_row(row)) {
+            for (size_t col = 0; col < source.cols; ++col) {
+                uint8_t index = 0;
+                if (!tile_index(row[col], index)) return false;
+
+                for (size_t i = 0; i < scale; ++i) {
+                    copy(palette[index].begin(), palette[index].end(), line.begin() + (col * scale + i) * 3);
+                }
+            }
+
+            for (unsigned int i = 0; i < scale; ++i) out.write(line.data(), static_cast<streamsize>(line.size()));
+        }
+
+        return static_cast<bool>(out);
+    }
+
+    uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size) {
+        static const array<uint32_t, 256> table = [] {
+            array<uint32_t, 256> t{};
+            for (uint32_t n = 0; n < 256; ++n) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[n] = c;
+            }
+            return t;
+        }();
+
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    void put_u32(vector<uint8_t>& out, uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+
+    void write_chunk(ostream& out, const char* type, const vector<uint8_t>& data) {
+        vector<uint8_t> chunk;
+        put_u32(chunk, static_cast<uint32_t>(data.size()));
+        chunk.insert(chunk.end(), type, type + 4);
+        chunk.insert(chunk.end(), data.begin(), data.end());
+        put_u32(chunk, crc32(0, chunk.data() + 4, chunk.size() - 4));
+
+        out.write(reinterpret_cast<const char*>(chunk.data()), static_cast<streamsize>(chunk.size()));
+    }
+
+    /*
+     * Streaming zlib encoder using fixed Huffman codes and run-length matches (distance 1).
+     * Compressed bytes are handed out as IDAT chunks whenever CHUNK_SIZE is reached.
+     */
+    struct Deflate {
+        ostream& out;
+        vector<uint8_t> pending;
+        uint64_t bits = 0;
+        int bit_count = 0;
+        uint32_t adler_a = 1, adler_b = 0;
+        int last = -1;
+        unsigned int run = 0;
+
+        static constexpr array<uint16_t, 29> length_base = {
+                3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+        };
+        static constexpr array<uint8_t, 29> length_extra = {
+                0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+        };
+
+        explicit Deflate(ostream& out) : out(out) {
+            pending = {0x78, 0x01};
+            put_bits(0, 1);
+            put_bits(1, 2);
+        }
+
+        void put_bits(uint32_t value, int count) {
+            bits |= static_cast<uint64_t>(value) << bit_count;
+            bit_count += count;
+
+            while (bit_count >= 8) {
+                pending.push_back(static_cast<uint8_t>(bits));
+                bits >>= 8;
+                bit_count -= 8;
+            }
+
+            if (pending.size() >= CHUNK_SIZE) flush_chunk();
+        }
+
+        // Huffman codes are packed most significant bit first
+        void put_code(uint32_t code, int length) {
+            uint32_t reversed = 0;
+            for (int i = 0; i < length; ++i) reversed |= ((code >> i) & 1) << (length - 1 - i);
+            put_bits(reversed, length);
+        }
+
+        void put_symbol(unsigned int symbol) {
+            if (symbol < 144) put_code(0x30 + symbol, 8);
+            else if (symbol < 256) put_code(0x190 + symbol - 144, 9);
+            else if (symbol < 280) put_code(symbol - 256, 7);
+            else put_code(0xC0 + symbol - 280, 8);
+        }
+
+        void put_run() {
+            if (run < 3) {
+                for (; run > 0; --run) put_symbol(last);
+                return;
+            }
+
+            size_t code = upper_bound(length_base.begin(), length_base.end(), run) - length_base.begin() - 1;
+            put_symbol(257 + code);
+            put_bits(run - length_base[code], length_extra[code]);
+            put_code(0, 5);
+            run = 0;
+        }
+
+        void write(const uint8_t* data, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                uint8_t byte = data[i];
+
+                adler_a = (adler_a + byte) % 65521;
+                adler_b = (adler_b + adler_a) % 65521;
+
+                if (byte == last) {
+                    if (++run == 258) put_run();
+                    continue;
+                }
+
+                put_run();
+                put_symbol(byte);
+                last = byte;
+            }
+        }
+
+        void flush_chunk() {
+            if (pending.empty()) return;
+            write_chunk(out, "IDAT", pending);
+            pending.clear();
+        }
+
+        void finish() {
+            put_run();
+            put_symbol(256);
+
+            put_bits(1, 1);
+            put_bits(1, 2);
+            put_symbol(256);
+            if (bit_count > 0) put_bits(0, 8 - bit_count);
+
+            put_u32(pending, (adler_b << 16) | adler_a);
+            flush_chunk();
+        }
+    };
+
+    bool write_png(ostream& out, Source& source, unsigned int scale) {
+        constexpr array<uint8_t, 8> signature = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        out.write(reinterpret_cast<const char*>(signature.data()), signature.size());
+
+        vector<uint8_t> header;
+        put_u32(header, static_cast<uint32_t>(source.cols * scale));
+        put_u32(header, static_cast<uint32_t>(source.rows * scale));
+        header.insert(header.end(), {8, 3, 0, 0, 0});
+        write_chunk(out, "IHDR", header);
+
+        vector<uint8_t> colors;
+        for (const auto& color : palette) colors.insert(colors.end(), color.begin(), color.end());
+        write_chunk(out, "PLTE", colors);
+
+        Deflate deflate(out);
+
+        string row;
+        vector<uint8_t> line(source.cols * scale + 1);
+        vector<uint8_t> repeat(line.size(), 0);
+        repeat[0] = 2;
+
+        while (source.next_row(row)) {
+            line[0] = 0;
+
+            for (size_t col = 0; col < source.cols; ++col) {
+                uint8_t index = 0;
+                if (!tile_index(row[col], index)) return false;
+                fill_n(line.begin() + 1 + col * scale, scale, index);
+            }
+
+            // Repeated scanlines use the Up filter, which turns them into a single run of zeros
+            deflate.write(line.data(), line.size());
+            for (unsigned int i = 1; i < scale; ++i) deflate.write(repeat.data(), repeat.size());
+        }
+
+        deflate.finish();
+        write_chunk(out, "IEND", {});
+
+        return static_cast<bool>(out);
+    }
+
+    bool parse(int argc, char* argv[], Options& options) {
+        options.output = argv[2];
+
+        vector<pair<string, string>> pairs;
+        if (!cli::options(argc, argv, 3, pairs)) return false;
+
+        for (const auto& [arg, value] : pairs) {
+            try {
+                if (arg == "--input") {
+                    options.input = value;
+                } else if (arg == "--size") {
+                    pair<unsigned int, unsigned int> size;
+                    if (!cli::parse_size(value, size)) throw invalid_argument(value);
+                    tie(options.rows, options.cols) = size;
+                } else if (arg == "--seed") {
+                    options.seed = stoul(value);
+                } else if (arg == "--scale") {
+                    options.scale = max(1ul, stoul(value));
+                } else {
+                    cerr << "Unknown option " << arg << endl;
+                    return false;
+                }
+            } catch (const exception&) {
+                cerr << "Invalid value for " << arg << ": " << value << endl;
+                return false;
+            }
+        }
+
+        return options.input.empty() ? cli::valid_size(options.rows, options.cols) : true;
+    }
+
+    int run(const Options& options) {
+        Source source;
+        ifstream in;
+        vector<vector<char>> maze;
+
+        if (!options.input.empty()) {
+            in.open(options.input);
+            if (!in) {
+                cerr << "Could not open " << options.input << endl;
+                return 1;
+            }
+
+            if (!stream_source(in, source)) return 1;
+        } else {
+            tie(maze, ignore, ignore) = map::generate_maze(options.rows, options.cols, {1, 1}, options.seed);
+            source = grid_source(maze);
+        }
+
+        ofstream out(options.output, ios::binary);
+        if (!out) {
+            cerr << "Could not open " << options.output << endl;
+            return 1;
+        }
+
+        bool png = options.output.size() >= 4 && options.output.substr(options.output.size() - 4) == ".png";
+
+        bool written = png ? write_png(out, source, options.scale) : write_ppm(out, source, options.scale);
+
+        // Never leave a truncated image behind
+        if (!written || !out) {
+            out.close();
+            error_code error;
+            filesystem::remove(options.output, error);
+            return 1;
+        }
+
+        return 0;
+    }
+}
+
+namespace bench {
+    struct Options {
+        vector<pair<unsigned int, unsigned int>> sizes = {{1023, 1023}, {8191, 8191}};
+        unsigned int seed = 1;
+        unsigned int repeat = 3;
+    };
+
+    double milliseconds(chrono::steady_clock::duration duration) {
+        return chrono::duration<double, milli>(duration).count();
+    }
+
+    // Times carving and the farthest-point search separately, keeping the best of each.
+    // Returns false if a repeat after the first allocated, the workspace should have grown to size by then
+    template <typename Maze, typename Visited>
+    bool measure(const string& layout, unsigned int rows, unsigned int cols, const Options& options) {
+        stats::Scope scope(stats::Map);
+        uint64_t allocations = stats::local(), bytes = stats::bytes(stats::Map);
+        uint64_t first_allocations = 0;
+        unsigned int allocating_repeats = 0;
+
+        map::BasicWorkspace<Maze, Visited> ws;
+
+        double generate_ms = numeric_limits<double>::max(), bfs_ms = numeric_limits<double>::max();
+        int max_dist = 0;
+
+        for (unsigned int i = 0; i < options.repeat; ++i) {
+            uint64_t before = stats::local();
+            auto start = chrono::steady_clock::now();
+
+            mt19937 gen(options.seed);
+            map::reset_maze(ws.maze, rows, cols);
+            map::clear_visited(ws.visited, rows, cols);
+            map::dfs(1, 1, ws.maze, ws.visited, gen, ws.stack);
+
+            auto carved = chrono::steady_clock::now();
+
+            tie(ignore, max_dist) = map::find_farthest_point(ws.maze, 1, 1, ws.visited, ws.queue);
+
+            auto searched = chrono::steady_clock::now();
+
+            generate_ms = min(generate_ms, milliseconds(carved - start));
+            bfs_ms = min(bfs_ms, milliseconds(searched - carved));
+
+            if (i == 0) first_allocations = stats::local() - before;
+            else allocating_repeats += stats::local() != before;
+        }
+
+        cout << layout << ',' << rows << ',' << cols << ',' << generate_ms << ',' << bfs_ms << ',' << max_dist;
+
+        if (stats::ENABLED) {
+            cout << ',' << first_allocations << ',' << stats::local() - allocations << ',' << stats::bytes(stats::Map) - bytes
+                 << ',' << allocating_repeats << ',' << stats::peak_rss() / 1024;
+        }
+
+        cout << endl;
+        return allocating_repeats == 0;
+    }
+
+    bool parse(int argc, char* argv[], Options& options) {
+        vector<pair<string, string>> pairs;
+        if (!cli::options(argc, argv, 2, pairs)) return false;
+
+        for (const auto& [arg, value] : pairs) {
+            try {
+                if (arg == "--sizes") {
+                    options.sizes.clear();
+
+                    for (const auto& text : cli::split(value, ',')) {
+                        pair<unsigned int, unsigned int> size;
+                        if (!cli::parse_size(text, size)) throw invalid_argument(text);
+                        options.sizes.push_back(size);
+                    }
+                } else if (arg == "--seed") {
+                    options.seed = stoul(value);
+                } else if (arg == "--repeat") {
+                    options.repeat = max(1ul, stoul(value));
+                } else {
+                    cerr << "Unknown option " << arg << endl;
+                    return false;
+                }
+            } catch (const exception&) {
+                cerr << "Invalid value for " << arg << ": " << value << endl;
+                return false;
+            }
+        }
+
+        for (auto [rows, cols] : options.sizes) {
+            if (!cli::valid_size(rows, cols)) return false;
+        }
+
+        return true;
+    }
+
+    int run(const Options& options) {
+        cout << "layout,rows,cols,generate_ms,bfs_ms,max_dist";
+        if (stats::ENABLED) cout << ",first_allocations,allocations,allocated_bytes,allocating_repeats,peak_rss_kib";
+        cout << endl;
+
+        bool steady = true;
+        for (auto [rows, cols] : options.sizes) {
+            steady &= measure<vector<vector<char>>, vector<vector<bool>>>("nested", rows, cols, options);
+            steady &= measure<grid::Grid<grid::RowMajor>, grid::Grid<grid::RowMajor>>("row-major", rows, cols, options);
+            steady &= measure<grid::Grid<grid::Tiled>, grid::Grid<grid::Tiled>>("tiled", rows, cols, options);
+            steady &= measure<grid::Grid<grid::Morton>, grid::Grid<grid::Morton>>("morton", rows, cols, options);
+        }
+
+        return steady ? 0 : stats::REGRESSION_EXIT_CODE;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--batch") {
+        batch::Options options;
+        if (!batch::parse(argc, argv, options)) return 1;
+
+        return batch::run(options);
+    }
+
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        bench::Options options;
+        if (!bench::parse(argc, argv, options)) return 1;
+
+        return bench::run(options);
+    }
+
+    if (argc > 2 && string(argv[1]) == "--export") {
+        image::Options options;
+        if (!image::parse(argc, argv, options)) return 1;
+
+        return image::run(options);
+    }
+
+    if (argc > 1 && string(argv[1]) == "--select") {
+        game::Options options;
+        if (!game::parse(argc, argv, 2, options)) return 1;
+
+        if (game::plays(options)) {
+            cerr << "--cache, --cache-budget, --feed, --overview and --stats only apply to a game" << endl;
+            return 1;
+        }
+
+        selection::Result result = selection::select(
+                options.rows, options.cols, {1, 1}, options.seed, options.candidates, options.threads, options.target
+        );
+
+        cout << "seed,candidate,max_dist,solution,dead_ends,qualified\n"
+             << result.seed << ',' << result.index << ',' << result.max_dist << ','
+             << result.solution << ',' << result.dead_ends << ',' << result.qualified << endl;
+
+        return result.qualified ? 0 : 2;
+    }
+
+    stats::Scope scope(stats::Game);
+
+    game::Options options;
+    if (!game::parse(argc, argv, 1, options)) return 1;
+
+    constexpr pair<int, int> start_position = {1, 1};
+
+    unsigned int rows = options.rows;
+    unsigned int cols = options.cols;
+
+    /*
+     * With a difficulty target the seed option is the base the candidate seeds are derived from.
+     * The selection runs on the generator thread unless the cache remembers its winner, in which
+     * case the winner's maze is usually cached as well.
+     */
+    bool targeted = game::has_target(options);
+    bool selecting = targeted;
+    selection::Result selected;
+    unsigned int seed = options.seed;
+
+    cache::Key base_key = {map::algorithms[0], rows, cols, start_position, options.seed};
+    if (targeted && !options.cache.empty() &&
+        cache::load_choice(options.cache, base_key, options.candidates, options.target, selected)) {
+        seed = selected.seed;
+        selecting = false;
+    }
+
+    feed::Mapping spectators;
+    bool feeding = !options.feed.empty();
+    if (feeding && !feed::create(spectators, options.feed, rows, cols)) {
+        cerr << "Could not create spectator feed " << options.feed << endl;
+        return 1;
+    }
+
+    terminal::init();
+
+    vector<vector<char>> map;
+    pair<int, int> end_cell = {-1, -1};
+    int max_dist = 0;
+
+    cache::Key key = {map::algorithms[0], rows, cols, start_position, seed};
+    bool generated = !selecting && !options.cache.empty() && cache::load(options.cache, key, map, end_cell, max_dist);
+
+    map::Progress progress;
+    map::Workspace ws;
+    thread generator;
+
+    // On a cache miss the board starts out as unconnected cells and fills in while the generator thread carves it
+    if (!generated) {
+        map = map::generate_empty_maze(rows, cols);
+
+        // The game loop only reads `seed` and `selected` once the maze is done, which the progress lock orders
+        generator = thread([&]() {
+            stats::Scope scope(stats::Map);
+
+            if (selecting) {
+                selected = selection::select(
+                        rows, cols, start_position, options.seed, options.candidates, options.threads, options.target,
+                        &ws.maze, &progress.stop
+                );
+                if (progress.stop) return;
+
+                seed = key.seed = selected.seed;
+                map::publish(progress, ws.maze, selected.end_cell, selected.max_dist);
+
+                if (!options.cache.empty()) {
+                    cache::store_choice(options.cache, base_key, options.candidates, options.target, selected);
+                }
+            } else if (!map::generate_progressively(ws, rows, cols, start_position, seed, progress)) return;
+
+            if (!options.cache.empty()) {
+                cache::store(options.cache, key, options.cache_budget, ws.maze, progress.end_cell, progress.max_dist);
+            }
+        });
+    }
+
+    vector<pair<int, int>> carved;
+
+    vector<vector<char>> old_matrix = map;
+
+    pair<int, int> player_location = start_position;
+    old_matrix[player_location.first][player_location.second] = map::TILE_PLAYER;
+
+    // The overview keeps a few lines free below the board for the finish screen
+    overview::View view;
+    if (options.overview != overview::None) {
+        auto [lines, columns] = terminal::size();
+        overview::build(view, old_matrix, options.overview, lines > 8 ? lines - 8 : 1, columns);
+        overview::draw(view, old_matrix);
+    } else render::render(old_matrix, old_matrix, true);
+
+    game::Usage usage;
+
+    auto draw = [&](span<const pair<int, int>> cells) {
+        if (options.overview != overview::None) {
+            overview::draw_cells(view, old_matrix, cells);
+        } else render::render_cells(old_matrix, cells);
+    };
+
+    // Frames while playing must not allocate, the carved batches drawn during generation still grow the buffer
+    auto repaint = [&](span<const pair<int, int>> cells) {
+        uint64_t before = stats::local();
+        draw(cells);
+
+        usage.frames++;
+        usage.allocating_frames += stats::local() != before;
+    };
+
+    pair<int, int> offset;
+
+    int moves = 0;
+
+    // Distance to the goal is kept up to date per move, the field only has to be walked after a jump
+    guide::Field field;
+    int to_goal = 0;
+    vector<pair<int, int>> hinted;
+
+    if (generated) {
+        guide::build(field, map, end_cell);
+        to_goal = guide::distance(field, player_location, end_cell);
+    }
+
+    auto status = [&]() {
+        if (!generated) return;
+
+        char text[128];
+        int length = snprintf(
+                text, sizeof(text), "Moves: %d  To goal: %d  Optimal: %d  Wasted: %d%s",
+                moves, to_goal, max_dist, moves + to_goal - max_dist,
+                targeted && !selected.qualified ? "  (no candidate met the target)" : ""
+        );
+        render::status(string_view(text, max(0, length)));
+    };
+
+    status();
+
+    history::Log log;
+    history::reset(log, player_location);
+
+    if (feeding) {
+        feed::publish_move(spectators, player_location);
+        if (generated) feed::publish_board(spectators, map);
+    }
+
+    chrono::time_point start = chrono::high_resolution_clock::now();
+
+    while (true) {
+        if (!generated) {
+            generated = game::apply_progress(progress, map, old_matrix, carved, end_cell, max_dist);
+
+            if (!carved.empty()) draw(carved);
+            carved.clear();
+
+            if (generated) {
+                guide::build(field, map, end_cell);
+                to_goal = guide::distance(field, player_location, end_cell);
+                status();
+
+                if (feeding) feed::publish_board(spectators, map);
+            }
+
+            if (!generated && !_kbhit()) {
+                this_thread::sleep_for(game::POLL_INTERVAL);
+                continue;
+            }
+        }
+
+        if (player_location == end_cell) {
+            chrono::time_point end = chrono::high_resolution_clock::now();
+            chrono::duration duration = end - start;
+            int64_t total_seconds = chrono::duration_cast<chrono::seconds>(duration).count();
+
+            int64_t minutes = (total_seconds % 3600) / 60;
+            int64_t seconds = total_seconds % 60;
+
+            int moves_per_second = static_cast<int>(round(moves / max<double>(chrono::duration<double>(duration).count(), 1)));
+
+            cout << "\n"
+                 << "You finished!\n"
+                 << "=====================\n"
+                 << "Total Time  : " << minutes << "m " << seconds << "s\n"
+                 << "Total Moves : " << moves << "\n"
+                 << "Min. Moves  : " << max_dist << "\n"
+                 << "Wasted Moves: " << moves - max_dist << "\n"
+                 << "Moves / s   : " << moves_per_second << "\n"
+                 << "Seed        : " << seed << "\n";
+
+            if (targeted) {
+                cout << "Target      : " << (selected.qualified ? "met" : "missed, closest candidate played") << "\n";
+            }
+
+            cout << "=====================\n";
+
+            break;
+        }
+
+        offset = game::input();
+
+        // A hint only lasts until the next key
+        if (!hinted.empty()) {
+            for (auto [r, c] : hinted) {
+                if (old_matrix[r][c] == map::TILE_HINT) old_matrix[r][c] = map[r][c];
+            }
+
+            repaint(hinted);
+            hinted.clear();
+        }
+
+        if (offset == game::EXIT_CODE) {
+            if (generated) cout << "\n";
+            break;
+        }
+
+        if (offset == game::HINT_CODE) {
+            if (!generated) continue;
+
+            hinted = guide::hint(field, player_location, end_cell);
+            for (auto [r, c] : hinted) old_matrix[r][c] = map::TILE_HINT;
+
+            repaint(hinted);
+        } else if (offset.first == game::REWIND_CODE || offset.first == game::FORWARD_CODE) {
+            pair<int, int> previous = player_location;
+
+            if (offset.first == game::REWIND_CODE) {
+                player_location = history::rewind(log, offset.second);
+            } else player_location = history::forward(log, offset.second);
+
+            if (player_location != previous) {
+                old_matrix[previous.first][previous.second] = map[previous.first][previous.second];
+                old_matrix[player_location.first][player_location.second] = map::TILE_PLAYER;
+
+                array<pair<int, int>, 2> cells = {previous, player_location};
+                repaint(cells);
+                if (feeding) feed::publish_move(spectators, player_location);
+
+                if (generated) to_goal = guide::distance(field, player_location, end_cell);
+                status();
+            }
+        } else {
+            uint64_t before = stats::local();
+            pair<int, int> previous = player_location;
+
+            if (game::update_matrix(map, old_matrix, player_location, offset)) {
+                array<pair<int, int>, 2> cells = {previous, player_location};
+                repaint(cells);
+
+                history::record(log, offset, player_location);
+                if (feeding) feed::publish_move(spectators, player_location);
+
+                if (generated) to_goal = guide::moved(field, to_goal, previous, player_location);
+                moves++;
+                status();
+
+                usage.moves++;
+                usage.allocating_moves += stats::local() != before;
+            }
+        }
+    }
+
+    // Whatever the generator thread is still doing is no longer needed
+    progress.stop = true;
+
+    if (options.stats == "-") {
+        game::report(cout, usage);
+    } else if (!options.stats.empty()) {
+        ofstream out(options.stats);
+        game::report(out, usage);
+    }
+
+    cout << "Press enter to exit" << endl;
+
+    terminal::deinit();
+
+    cin.get();
+
+    if (generator.joinable()) generator.join();
+
+    feed::close(spectators);
+
+    // Only a run that asked for --stats is held to zero allocations per move and per frame
+    if (!options.stats.empty() && game::regressed(usage)) return stats::REGRESSION_EXIT_CODE;
 
     return 0;
 }
\ No newline at end of file
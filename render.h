@@ -0,0 +1,213 @@
+/********************************************
+ *  Project     : Le Maze
+ *  File        : render.h
+ *  Author      : Kai Parsons
+ *  Date        : 2026-10-18
+ *  Description : Terminal setup and maze
+ *                rendering shared by the
+ *                game and the spectator.
+ ********************************************/
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <span>
+#include <charconv>
+#include <cmath>
+
+#include <windows.h>
+
+#include "stats.h"
+
+namespace map {
+    constexpr char TILE_WALL = '1';
+    constexpr char TILE_PATH = '0';
+    constexpr char TILE_PLAYER = '2';
+    constexpr char TILE_GOAL = '3';
+    constexpr char TILE_HINT = '4';
+}
+
+namespace terminal {
+    inline void enable_virtual_terminal() {
+        HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
+        DWORD dwMode = 0;
+        GetConsoleMode(hOut, &dwMode);
+        dwMode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
+        SetConsoleMode(hOut, dwMode);
+    }
+
+    inline void cursor(bool visible) {
+        HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
+        CONSOLE_CURSOR_INFO cursorInfo;
+        GetConsoleCursorInfo(hOut, &cursorInfo);
+
+        if (visible) {
+            cursorInfo.bVisible = TRUE;
+        } else cursorInfo.bVisible = FALSE;
+        SetConsoleCursorInfo(hOut, &cursorInfo);
+    }
+
+    inline void init(const char* title = "Le Maze") {
+        enable_virtual_terminal();
+        cursor(false);
+        SetConsoleOutputCP(CP_UTF8);
+        SetConsoleTitle(title);
+    }
+
+    // Visible lines and columns of the console window
+    inline std::pair<size_t, size_t> size() {
+        CONSOLE_SCREEN_BUFFER_INFO info;
+        if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) return {25, 80};
+
+        return {
+                info.srWindow.Bottom - info.srWindow.Top + 1,
+                info.srWindow.Right - info.srWindow.Left + 1
+        };
+    }
+
+    inline void deinit() {
+        cursor(true);
+    }
+}
+
+namespace render {
+    // Indexed by tile - '0', so a frame never builds a string to look up its colours
+    constexpr std::array<const char*, 5> foreground = {"\033[30m", "\033[37m", "\033[31m", "\033[33m", "\033[32m"};
+    constexpr std::array<const char*, 5> background = {"\033[40m", "\033[47m", "\033[41m", "\033[43m", "\033[42m"};
+    constexpr const char* RESET = "\033[0m";
+
+    constexpr std::string PIXEL = "▀";
+
+    inline const char* fg(char tile) {
+        return foreground[tile - '0'];
+    }
+
+    inline const char* bg(char tile) {
+        return background[tile - '0'];
+    }
+
+    // Frames are built in one buffer that keeps its capacity, so repaints stop allocating once it has grown
+    inline std::string& buffer() {
+        static thread_local std::string out;
+        out.clear();
+        return out;
+    }
+
+    inline void flush(const std::string& out) {
+        std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+    }
+
+    inline void move(char direction, int characters, std::string& out) {
+        char digits[16];
+        auto [end, error] = std::to_chars(digits, digits + sizeof(digits), characters);
+
+        out += "\033[";
+        out.append(digits, end);
+        out += direction;
+    }
+
+    inline void up(int characters, std::string& out) {
+        move('A', characters, out);
+    }
+
+    inline void right(int characters, std::string& out) {
+        move('C', characters, out);
+    }
+
+    inline void down(int characters, std::string& out) {
+        move('B', characters, out);
+    }
+
+    inline void render_pixel(std::string& out, const std::vector<std::vector<char>>& matrix, size_t row, size_t col) {
+        const char& top = matrix[row][col];
+        const char& bottom = matrix[row + 1][col];
+
+        out += fg(top);
+        out += bg(bottom);
+        out += PIXEL;
+    }
+
+    inline void render(
+            std::vector<std::vector<char>>& old_matrix, const std::vector<std::vector<char>>& new_matrix, bool first_frame
+    ) {
+        stats::Scope scope(stats::Render);
+        std::string& out = buffer();
+
+        if (!first_frame) up(static_cast<int>(ceil(old_matrix.size() / 2) + 1), out);
+
+        for (size_t row = 0; row + 1 < old_matrix.size(); row += 2) {
+            for (size_t col = 0; col < old_matrix[row].size(); ++col) {
+                if (!first_frame) {
+                    if (
+                        old_matrix[row][col] != new_matrix[row][col] ||
+                        old_matrix[row + 1][col] != new_matrix[row + 1][col]
+                    ) {
+                        render_pixel(out, new_matrix, row, col);
+                    } else right(1, out);
+                } else render_pixel(out, new_matrix, row, col);
+            }
+
+            out += RESET;
+            out += '\n';
+        }
+
+        if (old_matrix.size() % 2 != 0) {
+            size_t last_row = old_matrix.size() - 1;
+
+            for (int i = 0; i <= old_matrix[last_row].size() - 1; ++i) {
+                if (!first_frame) {
+                    if (old_matrix[last_row][i] != new_matrix[last_row][i]) {
+                        out += fg(new_matrix[last_row][i]);
+                        out += PIXEL;
+                    } else right(1, out);
+                } else {
+                    out += fg(new_matrix[last_row][i]);
+                    out += PIXEL;
+                }
+            }
+
+            out += RESET;
+            out += '\n';
+        }
+
+        flush(out);
+    }
+
+    // Repaints only the given cells, assuming the cursor sits below the last frame
+    inline void render_cells(const std::vector<std::vector<char>>& matrix, std::span<const std::pair<int, int>> cells) {
+        stats::Scope scope(stats::Render);
+        std::string& out = buffer();
+
+        int lines = static_cast<int>(matrix.size() / 2 + matrix.size() % 2);
+
+        for (auto [row, col] : cells) {
+            int line = row / 2;
+
+            up(lines - line, out);
+            if (col > 0) right(col, out);
+
+            size_t top = static_cast<size_t>(line) * 2;
+            if (top + 1 < matrix.size()) {
+                render_pixel(out, matrix, top, col);
+            } else {
+                out += fg(matrix[top][col]);
+                out += PIXEL;
+            }
+
+            out += RESET;
+            out += '\r';
+            down(lines - line, out);
+        }
+
+        flush(out);
+    }
+
+    // Single line below the board, the cursor is left where it was so cell repaints stay aligned
+    inline void status(std::string_view text) {
+        std::cout << "\r" << text << "\033[K\r" << std::flush;
+    }
+}
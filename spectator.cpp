@@ -0,0 +1,144 @@
+/********************************************
+ *  Project     : Le Maze
+ *  File        : spectator.cpp
+ *  Author      : Kai Parsons
+ *  Date        : 2026-10-18
+ *  Description : Follows a running game
+ *                through its shared memory
+ *                feed.
+ ********************************************/
+
+#include <iostream>
+#include <conio.h>
+
+#include <vector>
+#include <array>
+#include <string>
+
+#include <chrono>
+#include <thread>
+
+#include <windows.h>
+
+#include "render.h"
+#include "feed.h"
+
+using namespace std;
+
+constexpr chrono::milliseconds POLL_INTERVAL(5);
+constexpr int CTRL_C = 3;
+
+// Sticky, so a Ctrl+C noticed inside a helper still ends the main loop
+bool stopping = false;
+
+bool quit() {
+    if (!stopping && _kbhit() && _getch() == CTRL_C) stopping = true;
+    return stopping;
+}
+
+// Waits out a torn player position, which never settles if the game died mid-move and nothing replaced it
+bool read_player(const feed::Mapping& mapping, pair<int, int>& player) {
+    uint32_t session = mapping.header->session.load(memory_order_acquire);
+
+    while (!feed::snapshot(mapping, player)) {
+        if (quit() || mapping.header->session.load(memory_order_acquire) != session) return false;
+        this_thread::sleep_for(POLL_INTERVAL);
+    }
+
+    return true;
+}
+
+bool inside(const vector<vector<char>>& maze, const pair<int, int>& position) {
+    return position.first >= 0 && position.second >= 0 &&
+           position.first < static_cast<int>(maze.size()) && position.second < static_cast<int>(maze[0].size());
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <feed name>" << endl;
+        return 1;
+    }
+
+    string name = argv[1];
+
+    terminal::init("Le Maze Spectator");
+
+    feed::Mapping mapping;
+    cout << "Waiting for " << name << "..." << endl;
+
+    while (!feed::open(mapping, name)) {
+        if (quit()) {
+            terminal::deinit();
+            return 0;
+        }
+
+        this_thread::sleep_for(chrono::milliseconds(100));
+    }
+
+    const feed::Header& header = *mapping.header;
+
+    vector<vector<char>> map;
+    vector<vector<char>> matrix;
+    uint32_t session = 0;
+    bool attached = false;
+
+    uint64_t cursor = 0;
+    pair<int, int> player;
+
+    while (!quit()) {
+        // A new board means a new game, catch up from the snapshot and draw it from scratch
+        if (!attached || header.session.load(memory_order_acquire) != session) {
+            attached = feed::read_board(mapping, map, session);
+            if (!attached) {
+                this_thread::sleep_for(POLL_INTERVAL);
+                continue;
+            }
+
+            cursor = header.head.load(memory_order_acquire);
+            if (!read_player(mapping, player)) {
+                attached = false;
+                continue;
+            }
+
+            matrix = map;
+            if (inside(matrix, player)) matrix[player.first][player.second] = map::TILE_PLAYER;
+
+            cout << endl;
+            render::render(matrix, matrix, true);
+            continue;
+        }
+
+        uint64_t head = header.head.load(memory_order_acquire);
+        if (head == cursor) {
+            this_thread::sleep_for(POLL_INTERVAL);
+            continue;
+        }
+
+        pair<int, int> previous = player;
+
+        // Positions are absolute, so only the newest one matters
+        bool lapped = head - cursor > feed::RING_SIZE;
+        if (!lapped) {
+            player = feed::unpack(header.ring[(head - 1) % feed::RING_SIZE].load(memory_order_relaxed));
+
+            // The game may have lapped the ring while it was being read
+            lapped = header.head.load(memory_order_acquire) - head + 1 > feed::RING_SIZE;
+        }
+
+        if (lapped && !read_player(mapping, player)) continue;
+
+        cursor = head;
+
+        if (!inside(matrix, player) || player == previous) continue;
+
+        if (inside(matrix, previous)) matrix[previous.first][previous.second] = map[previous.first][previous.second];
+        matrix[player.first][player.second] = map::TILE_PLAYER;
+        array<pair<int, int>, 2> cells = {previous, player};
+        render::render_cells(matrix, cells);
+    }
+
+    feed::close(mapping);
+    terminal::deinit();
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+/********************************************
+ *  Project     : Le Maze
+ *  File        : stats.h
+ *  Author      : Kai Parsons
+ *  Date        : 2026-10-18
+ *  Description : Allocation accounting per
+ *                subsystem, compiled in with
+ *                LEMAZE_STATS.
+ ********************************************/
+
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef LEMAZE_STATS
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+/*
+ * Allocations are charged to whichever tag the allocating thread has open. Scopes nest and
+ * restore the outer tag, so a render inside a move counts as render, not game.
+ *
+ * Without LEMAZE_STATS a Scope is empty and every counter reads zero, so the hooks cost nothing
+ * and call sites need no #ifdefs.
+ */
+namespace stats {
+    enum Tag : uint8_t {
+        Other,
+        Map,
+        Render,
+        Game,
+        TAGS
+    };
+
+    constexpr std::array<const char*, TAGS> names = {"other", "map", "render", "game"};
+
+    // Exit status of a run that allocated where it must not, for scripts to fail on
+    constexpr int REGRESSION_EXIT_CODE = 3;
+
+#ifdef LEMAZE_STATS
+    constexpr bool ENABLED = true;
+
+    struct Counters {
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> frees{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<int64_t> live{0};
+        std::atomic<int64_t> peak{0};
+    };
+
+    inline std::array<Counters, TAGS> counters;
+    inline thread_local Tag current = Other;
+    inline thread_local uint64_t local_allocations = 0;
+
+    class Scope {
+    public:
+        explicit Scope(Tag tag) : previous(current) {
+            current = tag;
+        }
+
+        ~Scope() {
+            current = previous;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Tag previous;
+    };
+
+    inline void allocated(Tag tag, size_t size) {
+        local_allocations++;
+
+        Counters& counter = counters[tag];
+        counter.allocations.fetch_add(1, std::memory_order_relaxed);
+        counter.bytes.fetch_add(size, std::memory_order_relaxed);
+
+        int64_t live = counter.live.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) + static_cast<int64_t>(size);
+        int64_t peak = counter.peak.load(std::memory_order_relaxed);
+        while (live > peak && !counter.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    }
+
+    inline void freed(Tag tag, size_t size) {
+        counters[tag].frees.fetch_add(1, std::memory_order_relaxed);
+        counters[tag].live.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+    }
+
+    inline uint64_t allocations(Tag tag) {
+        return counters[tag].allocations.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t bytes(Tag tag) {
+        return counters[tag].bytes.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t frees(Tag tag) {
+        return counters[tag].frees.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t peak(Tag tag) {
+        return static_cast<uint64_t>(counters[tag].peak.load(std::memory_order_relaxed));
+    }
+
+    // Allocations made by the calling thread, unaffected by whatever other threads are doing
+    inline uint64_t local() {
+        return local_allocations;
+    }
+
+    inline size_t peak_rss() {
+        PROCESS_MEMORY_COUNTERS info = {};
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info))) return 0;
+        return info.PeakWorkingSetSize;
+    }
+#else
+    constexpr bool ENABLED = false;
+
+    class Scope {
+    public:
+        explicit Scope(Tag) {}
+    };
+
+    inline uint64_t allocations(Tag) {
+        return 0;
+    }
+
+    inline uint64_t bytes(Tag) {
+        return 0;
+    }
+
+    inline uint64_t frees(Tag) {
+        return 0;
+    }
+
+    inline uint64_t peak(Tag) {
+        return 0;
+    }
+
+    inline uint64_t local() {
+        return 0;
+    }
+
+    inline size_t peak_rss() {
+        return 0;
+    }
+#endif
+}